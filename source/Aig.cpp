@@ -0,0 +1,190 @@
+#include "Aig.h"
+#include <utility>
+
+Aig::Aig() : _fanins{aig_undef, aig_undef}, _table(1024, 0) {}
+
+AigLit Aig::create_input() {
+    uint32_t node = static_cast<uint32_t>(get_nodes_count());
+    _fanins.push_back(aig_undef);
+    _fanins.push_back(aig_undef);
+    _inputs.push_back(node);
+    return aig_make_lit(node);
+}
+
+size_t Aig::_slot(AigLit lhs, AigLit rhs) const {
+    uint64_t key = (static_cast<uint64_t>(lhs) << 32) | rhs;
+    key *= 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(key >> 32) & (_table.size() - 1);
+}
+
+void Aig::_grow_table() {
+    std::vector<uint32_t> table(_table.size() * 2, 0);
+    std::swap(_table, table);
+    for (uint32_t node : table) {
+        if (node != 0) {
+            size_t slot = _slot(get_fanin0(node), get_fanin1(node));
+            while (_table[slot] != 0) {
+                slot = (slot + 1) & (_table.size() - 1);
+            }
+            _table[slot] = node;
+        }
+    }
+}
+
+AigLit Aig::_find_or_create(AigLit lhs, AigLit rhs) {
+    size_t slot = _slot(lhs, rhs);
+    for (; _table[slot] != 0; slot = (slot + 1) & (_table.size() - 1)) {
+        uint32_t node = _table[slot];
+        if (get_fanin0(node) == lhs && get_fanin1(node) == rhs) {
+            return aig_make_lit(node);
+        }
+    }
+
+    uint32_t node = static_cast<uint32_t>(get_nodes_count());
+    _fanins.push_back(lhs);
+    _fanins.push_back(rhs);
+    _table[slot] = node;
+    if (++_ands * 2 > _table.size()) {
+        _grow_table();
+    }
+    return aig_make_lit(node);
+}
+
+bool Aig::_rewrite(AigLit lhs, AigLit rhs, AigLit& result) {
+    /**
+     * two-level rules, lhs or rhs is an AND node: a = x & y, b -- the other operand
+     *      contradiction   (x & y) & !x = 0,  (x & y) & (!x & z) = 0
+     *      idempotence     (x & y) & x = x & y
+     *      subsumption     !(x & y) & !x = !x,  !(x & y) & (!x & z) = !x & z
+     *      substitution    !(x & y) & x = !y & x
+     *      resolution      !(x & y) & !(x & !y) = !x
+     **/
+    for (int side = 0; side != 2; ++side, std::swap(lhs, rhs)) {
+        if (!is_and_lit(lhs)) {
+            continue;
+        }
+        AigLit x = get_fanin0(aig_node(lhs));
+        AigLit y = get_fanin1(aig_node(lhs));
+
+        if (!aig_is_complemented(lhs)) {
+            if (rhs == aig_neg(x) || rhs == aig_neg(y)) {
+                result = aig_false;
+                return true;
+            }
+            if (rhs == x || rhs == y) {
+                result = lhs;
+                return true;
+            }
+            if (is_and_lit(rhs) && !aig_is_complemented(rhs)) {
+                AigLit z = get_fanin0(aig_node(rhs));
+                AigLit w = get_fanin1(aig_node(rhs));
+                if (z == aig_neg(x) || z == aig_neg(y) || w == aig_neg(x) || w == aig_neg(y)) {
+                    result = aig_false;
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        if (rhs == aig_neg(x) || rhs == aig_neg(y)) {
+            result = rhs;
+            return true;
+        }
+        if (rhs == x || rhs == y) {
+            result = make_and(rhs == x ? aig_neg(y) : aig_neg(x), rhs);
+            return true;
+        }
+        if (is_and_lit(rhs)) {
+            AigLit z = get_fanin0(aig_node(rhs));
+            AigLit w = get_fanin1(aig_node(rhs));
+            if (!aig_is_complemented(rhs)
+                    && (z == aig_neg(x) || z == aig_neg(y) || w == aig_neg(x) || w == aig_neg(y))) {
+                result = rhs;
+                return true;
+            }
+            if (aig_is_complemented(rhs)) {
+                // operands are sorted, a shared literal and an opposite one may stand in any position
+                AigLit shared = aig_undef;
+                if ((x == z && y == aig_neg(w)) || (x == w && y == aig_neg(z))) {
+                    shared = x;
+                } else if ((y == z && x == aig_neg(w)) || (y == w && x == aig_neg(z))) {
+                    shared = y;
+                }
+                if (shared != aig_undef) {
+                    result = aig_neg(shared);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+AigLit Aig::make_and(AigLit lhs, AigLit rhs) {
+    if (lhs > rhs) {
+        std::swap(lhs, rhs);
+    }
+    if (lhs == aig_false || lhs == aig_neg(rhs)) {
+        return aig_false;
+    }
+    if (lhs == aig_true || lhs == rhs) {
+        return rhs;
+    }
+
+    AigLit result;
+    if (_rewrite(lhs, rhs, result)) {
+        return result;
+    }
+    return _find_or_create(lhs, rhs);
+}
+
+AigLit Aig::make_xor(AigLit lhs, AigLit rhs) {
+    /** a ^ b = !(a & b) & !(!a & !b) over regular operands, the complements go to the result **/
+    bool parity = aig_is_complemented(lhs) != aig_is_complemented(rhs);
+    lhs = aig_regular(lhs);
+    rhs = aig_regular(rhs);
+    if (lhs == rhs) {
+        return parity ? aig_true : aig_false;
+    }
+    if (lhs == aig_false) {
+        return rhs ^ static_cast<AigLit>(parity);
+    }
+
+    AigLit result = make_and(aig_neg(make_and(lhs, rhs)), aig_neg(make_and(aig_neg(lhs), aig_neg(rhs))));
+    return result ^ static_cast<AigLit>(parity);
+}
+
+Aig Aig::compact(AigLit& root, std::vector<AigLit>& lits) const {
+    std::vector<bool> reachable(get_nodes_count(), false);
+    reachable[aig_node(root)] = true;
+    for (size_t node = get_nodes_count(); node-- != 1;) {
+        if (reachable[node] && is_and(static_cast<uint32_t>(node))) {
+            reachable[aig_node(get_fanin0(static_cast<uint32_t>(node)))] = true;
+            reachable[aig_node(get_fanin1(static_cast<uint32_t>(node)))] = true;
+        }
+    }
+
+    Aig result;
+    std::vector<AigLit> new_lits(get_nodes_count(), aig_undef);
+    new_lits[0] = aig_false;
+    auto remap = [&new_lits](AigLit lit) {
+        AigLit mapped = new_lits[aig_node(lit)];
+        return mapped == aig_undef ? aig_undef : mapped ^ static_cast<AigLit>(aig_is_complemented(lit));
+    };
+
+    for (uint32_t node = 1; node != get_nodes_count(); ++node) {
+        if (!reachable[node]) {
+            continue;
+        }
+        new_lits[node] = is_and(node) ? result.make_and(remap(get_fanin0(node)), remap(get_fanin1(node)))
+                                      : result.create_input();
+    }
+
+    root = remap(root);
+    for (AigLit& lit : lits) {
+        if (lit != aig_undef) {
+            lit = remap(lit);
+        }
+    }
+    return result;
+}
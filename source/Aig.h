@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using AigLit = uint32_t;    // 2 * node + 1 if the edge is complemented
+
+constexpr AigLit aig_false = 0;     // node 0 is the constant
+constexpr AigLit aig_true = 1;
+constexpr AigLit aig_undef = UINT32_MAX;
+
+inline AigLit aig_make_lit(uint32_t node, bool complemented = false) {return 2 * node + static_cast<AigLit>(complemented);}
+inline AigLit aig_neg(AigLit lit)                                    {return lit ^ 1;}
+inline AigLit aig_regular(AigLit lit)                                {return lit & ~AigLit(1);}
+inline uint32_t aig_node(AigLit lit)                                 {return lit >> 1;}
+inline bool aig_is_complemented(AigLit lit)                          {return lit & 1;}
+
+class Aig {
+    /**
+     * Structurally hashed And-Inverter Graph: every node is the constant, an input or a two-input AND,
+     * negation is a complemented edge. Nodes are created in topological order and never duplicated:
+     * make_and normalizes the operands (commutativity, constants, two-level rewriting rules) and looks the
+     * pair up in the integer hash table before creating a node.
+     * @private_fields:
+     *      _fanins             -- two operands of every node, inputs and the constant keep aig_undef
+     *      _inputs             -- input nodes in the order of creation
+     *      _table              -- open-addressing hash table of AND nodes keyed by their operand pair, 0 -- empty
+     *
+     * @methods:
+     *      create_input        -- new input node
+     *      make_and/or/xor     -- literal of the function of two literals, reusing existing nodes
+     *      compact             -- rebuild the nodes reachable from the root, the rewriting rules see the
+     *                             simplified operands, literals of the old graph are remapped
+     **/
+
+    public:
+        Aig();
+
+        AigLit create_input();
+        AigLit make_and(AigLit lhs, AigLit rhs);
+        AigLit make_or(AigLit lhs, AigLit rhs) {return aig_neg(make_and(aig_neg(lhs), aig_neg(rhs)));}
+        AigLit make_xor(AigLit lhs, AigLit rhs);
+
+        Aig compact(AigLit& root, std::vector<AigLit>& lits) const;
+
+        [[nodiscard]] size_t get_nodes_count()            const {return _fanins.size() / 2;}
+        [[nodiscard]] size_t get_ands_count()             const {return _ands;}
+        [[nodiscard]] std::vector<uint32_t> const& get_inputs() const {return _inputs;}
+        [[nodiscard]] bool is_and(uint32_t node)          const {return _fanins.at(2 * node) != aig_undef;}
+        [[nodiscard]] bool is_and_lit(AigLit lit)         const {return is_and(aig_node(lit));}
+        [[nodiscard]] AigLit get_fanin0(uint32_t node)    const {return _fanins.at(2 * node);}
+        [[nodiscard]] AigLit get_fanin1(uint32_t node)    const {return _fanins.at(2 * node + 1);}
+
+    private:
+        bool _rewrite(AigLit lhs, AigLit rhs, AigLit& result);
+        AigLit _find_or_create(AigLit lhs, AigLit rhs);
+        [[nodiscard]] size_t _slot(AigLit lhs, AigLit rhs) const;
+        void _grow_table();
+
+        std::vector<AigLit> _fanins;
+        std::vector<uint32_t> _inputs;
+        std::vector<uint32_t> _table;
+        size_t _ands = 0;
+};
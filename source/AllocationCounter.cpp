@@ -0,0 +1,37 @@
+#include "Stats.h"
+#include <cstdlib>
+#include <new>
+
+/**
+ * replacement of the global allocation functions that feeds the allocation counters of Stats. Linked only into
+ * the programs built with CIRCUITSAT_COUNT_ALLOCATIONS: the library itself never replaces operator new.
+ * The array, nothrow and sized forms of the standard library call these ones
+ **/
+
+namespace {
+
+[[maybe_unused]] bool const hook_linked = (Stats::enable_allocation_counting(), true);
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    Stats::count_allocation(size);
+    while (true) {
+        if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,237 @@
+#include "Batch.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+constexpr auto watch_period = std::chrono::milliseconds(10);
+
+size_t resident_set_size() {
+    /** current resident set of the process in bytes, 0 if /proc isn't available **/
+    std::ifstream statm("/proc/self/statm");
+    size_t pages_total = 0;
+    size_t pages_resident = 0;
+    if (!(statm >> pages_total >> pages_resident)) {
+        return 0;
+    }
+    return pages_resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+} // namespace
+
+bool BatchSolver::collect_paths(std::string const& source, std::vector<std::string>& paths) {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    if (fs::is_directory(source, error)) {
+        for (fs::directory_entry const& entry : fs::directory_iterator(source, error)) {
+            if (entry.is_regular_file(error) && entry.path().extension() == ".bench") {
+                paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return !error;
+    }
+
+    std::ifstream manifest(source);
+    if (!manifest.is_open()) {
+        return false;
+    }
+    fs::path base = fs::path(source).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t\r") + 1;
+        fs::path path = line.substr(begin, end - begin);
+        paths.push_back(path.is_absolute() ? path.string() : (base / path).string());
+    }
+    return true;
+}
+
+void BatchSolver::_watch() {
+    /**
+     * watchdog: sets the stop flag of the running instances that exceeded the time limit. Memory is charged to
+     * the process: while its resident set is above the limit, the most recently started instance is stopped,
+     * one at a time, so the memory the stopped instance frees is seen before the next one is chosen
+     **/
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_finished) {
+        _wake.wait_for(lock, watch_period);
+        auto now = std::chrono::steady_clock::now();
+        bool over_memory = _process_memory_limit != 0 && resident_set_size() > _process_memory_limit;
+        Slot* youngest = nullptr;
+        for (std::unique_ptr<Slot>& slot : _slots) {
+            if (!slot->active) {
+                continue;
+            }
+            if (slot->exceeded == LimitEnum::MEMORY) { // still releasing its memory
+                over_memory = false;
+            }
+            if (slot->exceeded != LimitEnum::NONE) {
+                continue;
+            }
+            if (_time_limit != 0 && now >= slot->deadline) {
+                slot->exceeded = LimitEnum::TIME;
+                slot->stop = true;
+            } else if (youngest == nullptr || slot->start > youngest->start) {
+                youngest = slot.get();
+            }
+        }
+        if (over_memory && youngest != nullptr) {
+            youngest->exceeded = LimitEnum::MEMORY;
+            youngest->stop = true;
+        }
+    }
+}
+
+void BatchSolver::_solve_instance(std::string const& path, Slot& slot, std::ostream& out, std::mutex& out_mutex) {
+    /**
+     * one instance: parse and simplify (or load from the cache) and solve under the stop flag of the slot.
+     * The time limit covers the whole instance, simplify and solve give up when the flag is set, an instance that
+     * ran out of memory in an allocation is reported the same way as one stopped by the watchdog
+     **/
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        slot.stop = false;
+        slot.exceeded = LimitEnum::NONE;
+        slot.start = start;
+        slot.deadline = start + std::chrono::seconds(_time_limit);
+        slot.active = true;
+    }
+
+    size_t gates_count = 0;
+    size_t simplified_count = 0;
+    Stats stats; // outside the try: an instance that ran out of memory still reports its phases
+    std::string result;
+    std::string witness_fields;
+    std::string outputs_field;
+    std::string error_field;
+    try {
+        CircuitSAT circuit;
+        circuit.set_engine(_engine);
+        circuit.set_sweeping(_sweeping);
+        circuit.set_threads_count(_threads_count);
+        circuit.set_stop(&slot.stop);
+        circuit.set_outputs_mode(_outputs_mode);
+        if (_stats_output) {
+            circuit.set_stats(&stats);
+        }
+
+        circuit.load_simplified(path, _cache_dir);
+        gates_count = circuit.get_parsed_gates_count();
+        simplified_count = circuit.get_gates_count();
+        bool sat = _count ? circuit.count() : circuit.solve();
+        std::vector<ValueEnum> const& results = circuit.get_output_results();
+        if (_count) { // SAT if some output has models
+            sat = std::find(results.begin(), results.end(), ValueEnum::True) != results.end();
+        }
+
+        VecGates const& outputs = circuit.get_output_indexes();
+        auto output_fields = [&circuit, &outputs](std::string const& field, std::vector<std::string> const& values) {
+            std::string res = ", \"" + field + "\": {";
+            for (size_t pos = 0; pos != outputs.size(); ++pos) {
+                std::string name(circuit.get_gate(outputs[pos]).get_name());
+                res += (pos == 0 ? "" : ", ") + json_string(name) + ": \"" + values[pos] + "\"";
+            }
+            return res + "}";
+        };
+        if (_count) { // decimal strings, the counts may exceed the precision of JSON numbers
+            std::vector<std::string> counts;
+            for (size_t pos = 0; pos != results.size(); ++pos) {
+                counts.push_back(results[pos] == ValueEnum::NotDetermined
+                                 ? "UNKNOWN" : circuit.get_output_counts()[pos].to_string());
+            }
+            outputs_field = _outputs_mode == OutputsEnum::EACH ? output_fields("counts", counts)
+                                                                : ", \"count\": \"" + counts.front() + "\"";
+        }
+        if (_outputs_mode == OutputsEnum::EACH) { // no common model, the result of every output instead
+            bool unknown = std::find(results.begin(), results.end(), ValueEnum::NotDetermined) != results.end();
+            result = sat ? "SAT" : unknown ? "UNKNOWN" : "UNSAT";
+            std::vector<std::string> values;
+            for (ValueEnum value : results) {
+                values.push_back(value == ValueEnum::True ? "SAT" : value == ValueEnum::False ? "UNSAT" : "UNKNOWN");
+            }
+            outputs_field = output_fields("outputs", values) + outputs_field;
+        } else if (sat && !_count && (_model_output || _check)) {
+            std::vector<bool> witness = circuit.get_witness();
+            if (_model_output) {
+                std::string bits(witness.size(), '0');
+                for (size_t pos = 0; pos != witness.size(); ++pos) {
+                    bits[pos] = witness[pos] ? '1' : '0';
+                }
+                witness_fields += ", \"model\": \"" + bits + "\"";
+            }
+            if (_check) {
+                bool checked = CircuitSAT::check_witness(path, witness, _outputs_mode);
+                witness_fields += std::string(", \"checked\": ") + (checked ? "true" : "false");
+            }
+        }
+        if (_outputs_mode != OutputsEnum::EACH) {
+            result = circuit.show_result();
+        }
+    } catch (ParseError const& error) { // a file that can't be read fails alone, the batch goes on
+        result = "ERROR";
+        error_field = ", \"error\": " + json_string(error.what());
+    } catch (std::bad_alloc const&) {
+        result = "MEMOUT";
+    }
+
+    LimitEnum exceeded;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        slot.active = false;
+        exceeded = slot.exceeded;
+    }
+    if (result == "UNKNOWN") {
+        result = exceeded == LimitEnum::MEMORY ? "MEMOUT" : "TIMEOUT";
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::string line = "{\"path\": " + json_string(path)
+                       + ", \"gates\": " + std::to_string(gates_count)
+                       + ", \"simplified\": " + std::to_string(simplified_count)
+                       + ", \"result\": \"" + result + "\"" + error_field + outputs_field + witness_fields
+                       + ", \"time\": " + std::to_string(elapsed.count())
+                       + (_stats_output ? ", \"stats\": " + stats.to_json() : "") + "}\n";
+    std::lock_guard<std::mutex> lock(out_mutex);
+    out << line << std::flush;
+}
+
+void BatchSolver::run(std::vector<std::string> const& paths, std::ostream& out) {
+    ThreadPool pool(_jobs_count);
+    _slots.clear();
+    for (size_t worker = 0; worker != pool.get_threads_count(); ++worker) {
+        _slots.push_back(std::make_unique<Slot>());
+    }
+    _finished = false;
+
+    std::thread watchdog;
+    if (_time_limit != 0 || _process_memory_limit != 0) {
+        watchdog = std::thread(&BatchSolver::_watch, this);
+    }
+
+    std::mutex out_mutex;
+    for (std::string const& path : paths) {
+        pool.submit([this, &path, &out, &out_mutex] {
+            _solve_instance(path, *_slots[ThreadPool::current_worker()], out, out_mutex);
+        });
+    }
+    pool.wait();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finished = true;
+    }
+    _wake.notify_all();
+    if (watchdog.joinable()) {
+        watchdog.join();
+    }
+}
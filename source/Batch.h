@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Circuit.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BatchSolver {
+    /**
+     * Batch mode: many circuits are solved by one resident process on a thread pool, every circuit is an
+     * independent CircuitSAT with its own stop flag. A watchdog thread sets the flag of an instance that
+     * runs longer than the time limit, and of the most recently started instance while the resident set of the
+     * whole process is above the process memory limit (instances share the heap, so memory isn't charged to one).
+     * Results are streamed as JSON lines in the order the instances finish.
+     * @private_fields:
+     *      _engine             -- algorithm used by every instance
+     *      _threads_count      -- threads used inside one instance (0 -- all cores)
+     *      _jobs_count         -- instances solved at the same time (0 -- all cores)
+     *      _time_limit         -- wall-clock limit of one instance in seconds, 0 -- none
+     *      _process_memory_limit -- resident set allowed to the whole process in bytes, 0 -- none
+     *      _model_output       -- satisfiable instances report the witness as a string of 0/1 over the inputs
+     *      _check              -- witnesses are checked by simulation of the circuit from the file
+     *      _outputs_mode       -- meaning of several outputs, in the EACH mode every output gets its own result
+     *      _count              -- the models of every instance are counted instead of solving it
+     *      _sweeping           -- simplify merges equivalent gates by SAT sweeping
+     *      _stats_output       -- every instance reports the times of its phases and the counters of the engine
+     *      _cache_dir          -- directory of the simplified circuits reused between runs, empty -- no cache
+     *      _slots              -- state of the instance running on every worker of the pool
+     *      _mutex, _wake       -- protect _slots and _finished, wake the watchdog
+     *
+     * @methods:
+     *      collect_paths       -- .bench files of a directory (sorted by name) or paths listed in a manifest
+     *                             (one per line, relative to the manifest, '#' starts a comment line)
+     *      run                 -- solve every path and write one JSON line per instance to out
+     **/
+
+    public:
+        BatchSolver(EngineEnum engine, size_t threads_count, size_t jobs_count)
+          : _engine(engine), _threads_count(threads_count), _jobs_count(jobs_count) {};
+
+        void set_time_limit(size_t seconds)                {_time_limit = seconds;}
+        void set_process_memory_limit(size_t megabytes)    {_process_memory_limit = megabytes << 20;}
+        void set_model_output(bool model_output)           {_model_output = model_output;}
+        void set_check(bool check)                         {_check = check;}
+        void set_outputs_mode(OutputsEnum mode)            {_outputs_mode = mode;}
+        void set_count(bool count)                         {_count = count;}
+        void set_sweeping(bool sweeping)                   {_sweeping = sweeping;}
+        void set_stats_output(bool stats_output)           {_stats_output = stats_output;}
+        void set_cache_dir(std::string cache_dir)          {_cache_dir = std::move(cache_dir);}
+
+        static bool collect_paths(std::string const& source, std::vector<std::string>& paths);
+        void run(std::vector<std::string> const& paths, std::ostream& out);
+
+    private:
+        enum class LimitEnum : uint8_t {NONE, TIME, MEMORY};
+
+        struct Slot {
+            std::atomic<bool> stop{false};
+            bool active = false;
+            LimitEnum exceeded = LimitEnum::NONE;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::steady_clock::time_point deadline;
+        };
+
+        void _solve_instance(std::string const& path, Slot& slot, std::ostream& out, std::mutex& out_mutex);
+        void _watch();
+
+        EngineEnum _engine;
+        size_t _threads_count;
+        size_t _jobs_count;
+        size_t _time_limit = 0;
+        size_t _process_memory_limit = 0;
+        bool _model_output = false;
+        bool _check = false;
+        OutputsEnum _outputs_mode = OutputsEnum::ANY;
+        bool _count = false;
+        bool _sweeping = true;
+        bool _stats_output = false;
+        std::string _cache_dir;
+
+        std::vector<std::unique_ptr<Slot>> _slots;
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        bool _finished = false;
+};
@@ -0,0 +1,106 @@
+#include "BigCount.h"
+#include <algorithm>
+#include <cassert>
+
+BigCount::BigCount(uint64_t value) {
+    for (; value != 0; value >>= 32) {
+        _limbs.push_back(static_cast<uint32_t>(value));
+    }
+}
+
+BigCount BigCount::power_of_two(size_t exponent) {
+    return BigCount(1).shift_left(exponent);
+}
+
+void BigCount::_trim() {
+    while (!_limbs.empty() && _limbs.back() == 0) {
+        _limbs.pop_back();
+    }
+}
+
+BigCount& BigCount::add(BigCount const& other) {
+    _limbs.resize(std::max(_limbs.size(), other._limbs.size()) + 1, 0);
+    uint64_t carry = 0;
+    for (size_t pos = 0; pos != _limbs.size(); ++pos) {
+        uint64_t sum = carry + _limbs[pos] + (pos < other._limbs.size() ? other._limbs[pos] : 0);
+        _limbs[pos] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    _trim();
+    return *this;
+}
+
+BigCount& BigCount::sub(BigCount const& other) {
+    assert(other._limbs.size() <= _limbs.size() && "Subtraction result is negative");
+    uint64_t borrow = 0;
+    for (size_t pos = 0; pos != _limbs.size(); ++pos) {
+        uint64_t subtrahend = borrow + (pos < other._limbs.size() ? other._limbs[pos] : 0);
+        borrow = _limbs[pos] < subtrahend ? 1 : 0;
+        _limbs[pos] = static_cast<uint32_t>((uint64_t(1) << 32) * borrow + _limbs[pos] - subtrahend);
+    }
+    assert(borrow == 0 && "Subtraction result is negative");
+    _trim();
+    return *this;
+}
+
+BigCount& BigCount::mul(BigCount const& other) {
+    /** schoolbook multiplication, the counts have a few limbs **/
+    std::vector<uint32_t> product(_limbs.size() + other._limbs.size(), 0);
+    for (size_t lhs = 0; lhs != _limbs.size(); ++lhs) {
+        uint64_t carry = 0;
+        for (size_t rhs = 0; rhs != other._limbs.size(); ++rhs) {
+            uint64_t cur = product[lhs + rhs] + uint64_t(_limbs[lhs]) * other._limbs[rhs] + carry;
+            product[lhs + rhs] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        product[lhs + other._limbs.size()] = static_cast<uint32_t>(carry);
+    }
+    _limbs = std::move(product);
+    _trim();
+    return *this;
+}
+
+BigCount& BigCount::shift_left(size_t bits) {
+    if (is_zero()) {
+        return *this;
+    }
+    _limbs.insert(_limbs.begin(), bits / 32, 0);
+    size_t shift = bits % 32;
+    if (shift != 0) {
+        uint32_t carry = 0;
+        for (uint32_t& limb : _limbs) {
+            uint32_t next = limb >> (32 - shift);
+            limb = (limb << shift) | carry;
+            carry = next;
+        }
+        if (carry != 0) {
+            _limbs.push_back(carry);
+        }
+    }
+    return *this;
+}
+
+std::string BigCount::to_string() const {
+    /** repeated division by 10^9, every remainder gives nine decimal digits **/
+    if (is_zero()) {
+        return "0";
+    }
+    std::vector<uint32_t> rest = _limbs;
+    std::string digits;
+    while (!rest.empty()) {
+        uint64_t remainder = 0;
+        for (size_t pos = rest.size(); pos-- != 0;) {
+            uint64_t cur = (remainder << 32) | rest[pos];
+            rest[pos] = static_cast<uint32_t>(cur / 1000000000);
+            remainder = cur % 1000000000;
+        }
+        while (!rest.empty() && rest.back() == 0) {
+            rest.pop_back();
+        }
+        for (int digit = 0; digit != 9 && (!rest.empty() || remainder != 0); ++digit) {
+            digits.push_back(static_cast<char>('0' + remainder % 10));
+            remainder /= 10;
+        }
+    }
+    return std::string(digits.rbegin(), digits.rend());
+}
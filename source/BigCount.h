@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BigCount {
+    /**
+     * Unsigned integer of any size for model counts: a circuit with n inputs has up to 2^n models.
+     * Little-endian 32-bit limbs, so products of limbs fit into uint64_t without compiler extensions.
+     * @private_fields:
+     *      _limbs              -- digits in base 2^32, no leading zero limbs (zero is the empty vector)
+     *
+     * @methods:
+     *      power_of_two        -- 2^exponent
+     *      add, sub, mul       -- arithmetic in place, sub requires a value not greater than this one
+     *      shift_left          -- multiply by 2^bits
+     *      to_string           -- decimal representation
+     **/
+
+    public:
+        BigCount() = default;
+        explicit BigCount(uint64_t value);
+        static BigCount power_of_two(size_t exponent);
+
+        BigCount& add(BigCount const& other);
+        BigCount& sub(BigCount const& other);
+        BigCount& mul(BigCount const& other);
+        BigCount& shift_left(size_t bits);
+
+        [[nodiscard]] bool is_zero()                       const {return _limbs.empty();}
+        [[nodiscard]] std::string to_string() const;
+
+        bool operator==(BigCount const& other)             const {return _limbs == other._limbs;}
+        bool operator!=(BigCount const& other)             const {return _limbs != other._limbs;}
+
+    private:
+        void _trim();
+
+        std::vector<uint32_t> _limbs;
+};
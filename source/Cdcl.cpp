@@ -0,0 +1,622 @@
+#include "Cdcl.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr double var_decay = 0.95;
+constexpr float clause_decay = 0.999f;
+constexpr uint64_t restart_unit = 100;   // conflicts in one unit of the Luby sequence
+constexpr size_t min_learnts = 2000;
+
+} // namespace
+
+double luby(double y, uint64_t x) {
+    /** x-th element of the Luby sequence scaled by y **/
+    uint64_t size = 1;
+    uint64_t seq = 0;
+    for (; size < x + 1; ++seq, size = 2 * size + 1) {}
+
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        --seq;
+        x = x % size;
+    }
+
+    double res = 1;
+    for (uint64_t i = 0; i != seq; ++i) {
+        res *= y;
+    }
+    return res;
+}
+
+void SharedClauses::publish(size_t source, std::vector<Lit> const& lits) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _clauses.emplace_back(source, lits);
+}
+
+void SharedClauses::collect(size_t source, size_t& cursor, std::vector<std::vector<Lit>>& clauses) {
+    /** clauses published by other solvers after the cursor **/
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (; cursor != _clauses.size(); ++cursor) {
+        if (_clauses[cursor].first != source) {
+            clauses.push_back(_clauses[cursor].second);
+        }
+    }
+}
+
+Var CdclSolver::new_var() {
+    Var var = static_cast<Var>(_assigns.size());
+    _assigns.push_back(-1);
+    _levels.push_back(0);
+    _reasons.push_back(clause_undef);
+    _activity.push_back(0.0);
+    _heap_index.push_back(-1);
+    _polarity.push_back(true);   // negative phase first
+    _seen.push_back(0);
+    _watches.emplace_back();
+    _watches.emplace_back();
+    _heap_insert(var);
+    return var;
+}
+
+float CdclSolver::_clause_activity(ClauseRef cref) const {
+    float activity;
+    std::memcpy(&activity, &_arena[cref + 2], sizeof(activity));
+    return activity;
+}
+
+void CdclSolver::_set_clause_activity(ClauseRef cref, float activity) {
+    std::memcpy(&_arena[cref + 2], &activity, sizeof(activity));
+}
+
+ClauseRef CdclSolver::_alloc_clause(std::vector<Lit> const& lits, bool learnt, uint32_t lbd) {
+    ClauseRef cref = static_cast<ClauseRef>(_arena.size());
+    _arena.push_back(static_cast<uint32_t>(lits.size()));
+    _arena.push_back((lbd << 2) | (learnt ? flag_learnt : 0));
+    _arena.push_back(0);
+    for (Lit lit : lits) {
+        _arena.push_back(static_cast<uint32_t>(lit));
+    }
+    return cref;
+}
+
+void CdclSolver::_attach_clause(ClauseRef cref) {
+    Lit* lits = _clause_lits(cref);
+    _watches[lits[0]].push_back({cref, lits[1]});
+    _watches[lits[1]].push_back({cref, lits[0]});
+}
+
+bool CdclSolver::add_clause(std::vector<Lit> lits) {
+    /** clauses are added at level 0: drop False and duplicated literals, skip satisfied clauses **/
+    if (!_ok) {
+        return false;
+    }
+    _cancel_until(0);
+
+    std::sort(lits.begin(), lits.end());
+    size_t size = 0;
+    for (size_t pos = 0; pos != lits.size(); ++pos) {
+        Lit lit = lits[pos];
+        if (_lit_value(lit) == 1 || (size != 0 && lits[size - 1] == lit_neg(lit))) {
+            return true;
+        }
+        if (_lit_value(lit) != 0 && (size == 0 || lits[size - 1] != lit)) {
+            lits[size++] = lit;
+        }
+    }
+    lits.resize(size);
+
+    if (lits.empty()) {
+        _ok = false;
+    } else if (lits.size() == 1) {
+        _enqueue(lits[0], clause_undef);
+        _ok = _propagate() == clause_undef;
+    } else {
+        ClauseRef cref = _alloc_clause(lits, false, 0);
+        _clauses.push_back(cref);
+        _attach_clause(cref);
+    }
+    return _ok;
+}
+
+void CdclSolver::_enqueue(Lit lit, ClauseRef reason) {
+    Var var = lit_var(lit);
+    _assigns[var] = static_cast<int8_t>(!lit_sign(lit));
+    _levels[var] = static_cast<uint32_t>(_decision_level());
+    _reasons[var] = reason;
+    _trail.push_back(lit);
+}
+
+void CdclSolver::_cancel_until(size_t level) {
+    if (_decision_level() <= level) {
+        return;
+    }
+    for (size_t pos = _trail.size(); pos != _trail_lim[level]; --pos) {
+        Var var = lit_var(_trail[pos - 1]);
+        _assigns[var] = -1;
+        _reasons[var] = clause_undef;
+        _polarity[var] = lit_sign(_trail[pos - 1]);
+        _heap_insert(var);
+    }
+    _trail.resize(_trail_lim[level]);
+    _trail_lim.resize(level);
+    _qhead = _trail.size();
+}
+
+ClauseRef CdclSolver::_propagate() {
+    /** unit propagation over two watched literals, returns the conflicting clause **/
+    ClauseRef conflict = clause_undef;
+
+    while (_qhead < _trail.size()) {
+        Lit false_lit = lit_neg(_trail[_qhead++]);
+        std::vector<Watcher>& watches = _watches[false_lit];
+        ++_propagations;
+
+        size_t keep = 0;
+        size_t pos = 0;
+        while (pos != watches.size()) {
+            Watcher watcher = watches[pos++];
+            if (_lit_value(watcher.blocker) == 1) {
+                watches[keep++] = watcher;
+                continue;
+            }
+
+            ClauseRef cref = watcher.cref;
+            Lit* lits = _clause_lits(cref);
+            if (lits[0] == false_lit) {
+                std::swap(lits[0], lits[1]);
+            }
+            Lit first = lits[0];
+            Watcher updated{cref, first};
+            if (first != watcher.blocker && _lit_value(first) == 1) {
+                watches[keep++] = updated;
+                continue;
+            }
+
+            // look for a new literal to watch
+            bool moved = false;
+            uint32_t size = _clause_size(cref);
+            for (uint32_t k = 2; k != size; ++k) {
+                if (_lit_value(lits[k]) != 0) {
+                    lits[1] = lits[k];
+                    lits[k] = false_lit;
+                    _watches[lits[1]].push_back(updated);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) {
+                continue;
+            }
+
+            // the clause is unit or conflicting
+            watches[keep++] = updated;
+            if (_lit_value(first) == 0) {
+                conflict = cref;
+                _qhead = _trail.size();
+                while (pos != watches.size()) {
+                    watches[keep++] = watches[pos++];
+                }
+            } else {
+                _enqueue(first, cref);
+            }
+        }
+        watches.resize(keep);
+    }
+    return conflict;
+}
+
+bool CdclSolver::_literal_redundant(Lit lit) {
+    /** the literal is implied by other literals of the learned clause **/
+    ClauseRef reason = _reasons[lit_var(lit)];
+    if (reason == clause_undef) {
+        return false;
+    }
+    Lit* lits = _clause_lits(reason);
+    for (uint32_t k = 1; k != _clause_size(reason); ++k) {
+        Var var = lit_var(lits[k]);
+        if (!_seen[var] && _levels[var] > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CdclSolver::_analyze(ClauseRef conflict, std::vector<Lit>& learnt, size_t& backtrack_level, uint32_t& lbd) {
+    /** first unique implication point **/
+    learnt.assign(1, lit_undef);
+    size_t path_count = 0;
+    Lit lit = lit_undef;
+    size_t index = _trail.size();
+
+    do {
+        if (_clause_learnt(conflict)) {
+            _bump_clause(conflict);
+        }
+        Lit* lits = _clause_lits(conflict);
+        for (uint32_t k = (lit == lit_undef ? 0 : 1); k != _clause_size(conflict); ++k) {
+            Var var = lit_var(lits[k]);
+            if (!_seen[var] && _levels[var] > 0) {
+                _bump_var(var);
+                _seen[var] = 1;
+                if (_levels[var] >= _decision_level()) {
+                    ++path_count;
+                } else {
+                    learnt.push_back(lits[k]);
+                }
+            }
+        }
+
+        while (!_seen[lit_var(_trail[--index])]) {}
+        lit = _trail[index];
+        conflict = _reasons[lit_var(lit)];
+        _seen[lit_var(lit)] = 0;
+        --path_count;
+    } while (path_count > 0);
+    learnt[0] = lit_neg(lit);
+
+    // drop literals implied by the rest of the clause
+    std::vector<Lit> analyzed(learnt.begin() + 1, learnt.end());
+    size_t size = 1;
+    for (size_t pos = 1; pos != learnt.size(); ++pos) {
+        if (!_literal_redundant(learnt[pos])) {
+            learnt[size++] = learnt[pos];
+        }
+    }
+    learnt.resize(size);
+    for (Lit analyzed_lit : analyzed) {
+        _seen[lit_var(analyzed_lit)] = 0;
+    }
+
+    // the literal with the highest level goes second, it is watched together with the asserting one
+    backtrack_level = 0;
+    if (learnt.size() > 1) {
+        size_t max_pos = 1;
+        for (size_t pos = 2; pos != learnt.size(); ++pos) {
+            if (_levels[lit_var(learnt[pos])] > _levels[lit_var(learnt[max_pos])]) {
+                max_pos = pos;
+            }
+        }
+        std::swap(learnt[1], learnt[max_pos]);
+        backtrack_level = _levels[lit_var(learnt[1])];
+    }
+
+    std::vector<uint32_t> levels;
+    for (Lit learnt_lit : learnt) {
+        levels.push_back(_levels[lit_var(learnt_lit)]);
+    }
+    std::sort(levels.begin(), levels.end());
+    lbd = static_cast<uint32_t>(std::unique(levels.begin(), levels.end()) - levels.begin());
+}
+
+void CdclSolver::_bump_var(Var var) {
+    if ((_activity[var] += _var_inc) > 1e100) {
+        for (double& activity : _activity) {
+            activity *= 1e-100;
+        }
+        _var_inc *= 1e-100;
+    }
+    if (_heap_index[var] >= 0) {
+        _heap_up(static_cast<size_t>(_heap_index[var]));
+    }
+}
+
+void CdclSolver::prioritize(Var var) {
+    /** activity above every variable waiting in the heap **/
+    double top = _heap.empty() ? 0.0 : _activity[_heap.front()];
+    _activity[var] = std::max(_activity[var], top);
+    _bump_var(var);
+}
+
+void CdclSolver::_bump_clause(ClauseRef cref) {
+    float activity = _clause_activity(cref) + _clause_inc;
+    _set_clause_activity(cref, activity);
+    if (activity > 1e20f) {
+        for (ClauseRef learnt : _learnts) {
+            _set_clause_activity(learnt, _clause_activity(learnt) * 1e-20f);
+        }
+        _clause_inc *= 1e-20f;
+    }
+}
+
+void CdclSolver::_heap_insert(Var var) {
+    if (_heap_index[var] >= 0) {
+        return;
+    }
+    _heap_index[var] = static_cast<int32_t>(_heap.size());
+    _heap.push_back(var);
+    _heap_up(_heap.size() - 1);
+}
+
+void CdclSolver::_heap_up(size_t pos) {
+    Var var = _heap[pos];
+    while (pos != 0) {
+        size_t parent = (pos - 1) / 2;
+        if (_activity[_heap[parent]] >= _activity[var]) {
+            break;
+        }
+        _heap[pos] = _heap[parent];
+        _heap_index[_heap[pos]] = static_cast<int32_t>(pos);
+        pos = parent;
+    }
+    _heap[pos] = var;
+    _heap_index[var] = static_cast<int32_t>(pos);
+}
+
+void CdclSolver::_heap_down(size_t pos) {
+    Var var = _heap[pos];
+    while (2 * pos + 1 < _heap.size()) {
+        size_t child = 2 * pos + 1;
+        if (child + 1 < _heap.size() && _activity[_heap[child + 1]] > _activity[_heap[child]]) {
+            ++child;
+        }
+        if (_activity[_heap[child]] <= _activity[var]) {
+            break;
+        }
+        _heap[pos] = _heap[child];
+        _heap_index[_heap[pos]] = static_cast<int32_t>(pos);
+        pos = child;
+    }
+    _heap[pos] = var;
+    _heap_index[var] = static_cast<int32_t>(pos);
+}
+
+Var CdclSolver::_heap_pop() {
+    Var top = _heap.front();
+    _heap_index[top] = -1;
+    _heap.front() = _heap.back();
+    _heap.pop_back();
+    if (!_heap.empty()) {
+        _heap_index[_heap.front()] = 0;
+        _heap_down(0);
+    }
+    return top;
+}
+
+Lit CdclSolver::_pick_branch_lit() {
+    while (!_heap.empty()) {
+        Var var = _heap_pop();
+        if (_assigns[var] < 0) {
+            return make_lit(var, _polarity[var]);
+        }
+    }
+    return lit_undef;
+}
+
+void CdclSolver::_reduce_db() {
+    /** remove the less useful half of learned clauses, glue clauses (LBD <= 2) and reasons are kept **/
+    std::sort(_learnts.begin(), _learnts.end(), [this](ClauseRef lhs, ClauseRef rhs) {
+        if (_clause_lbd(lhs) != _clause_lbd(rhs)) {
+            return _clause_lbd(lhs) > _clause_lbd(rhs);
+        }
+        return _clause_activity(lhs) < _clause_activity(rhs);
+    });
+
+    size_t half = _learnts.size() / 2;
+    for (size_t pos = 0; pos != half; ++pos) {
+        ClauseRef cref = _learnts[pos];
+        Lit first = _clause_lits(cref)[0];
+        bool locked = _lit_value(first) == 1 && _reasons[lit_var(first)] == cref;
+        if (!locked && _clause_lbd(cref) > 2) {
+            _arena[cref + 1] |= flag_deleted;
+        }
+    }
+    _collect_garbage();
+}
+
+void CdclSolver::_collect_garbage() {
+    /** compact the arena, clause references in watches, reasons and clause lists are remapped **/
+    std::vector<uint32_t> arena;
+    arena.reserve(_arena.size());
+    std::vector<ClauseRef> reasons = _reasons;
+
+    auto move_clauses = [&](std::vector<ClauseRef>& crefs) {
+        size_t keep = 0;
+        for (ClauseRef cref : crefs) {
+            if (_clause_deleted(cref)) {
+                continue;
+            }
+            uint32_t total = header_size + _clause_size(cref);
+            ClauseRef new_cref = static_cast<ClauseRef>(arena.size());
+            arena.insert(arena.end(), _arena.begin() + cref, _arena.begin() + cref + total);
+
+            Var var = lit_var(_clause_lits(cref)[0]);
+            if (_reasons[var] == cref) {
+                reasons[var] = new_cref;
+            }
+            crefs[keep++] = new_cref;
+        }
+        crefs.resize(keep);
+    };
+
+    // deleted clauses are never reasons, reasons of live clauses are remapped by the implied first literal
+    move_clauses(_clauses);
+    move_clauses(_learnts);
+    _arena = std::move(arena);
+    _reasons = std::move(reasons);
+
+    for (std::vector<Watcher>& watches : _watches) {
+        watches.clear();
+    }
+    for (ClauseRef cref : _clauses) {
+        _attach_clause(cref);
+    }
+    for (ClauseRef cref : _learnts) {
+        _attach_clause(cref);
+    }
+}
+
+bool CdclSolver::_import_shared() {
+    /** add clauses learned by other solvers, called at level 0 **/
+    if (_shared == nullptr) {
+        return _ok;
+    }
+    std::vector<std::vector<Lit>> clauses;
+    _shared->collect(_shared_id, _shared_cursor, clauses);
+    for (std::vector<Lit>& lits : clauses) {
+        if (!add_clause(std::move(lits))) {
+            break;
+        }
+    }
+    return _ok;
+}
+
+bool CdclSolver::probe(std::vector<Lit> const& cube, Lit lit, size_t& implied) {
+    /**
+     * lookahead: assign the cube and then lit, implied is the number of literals assigned by lit.
+     * Returns false if the cube or the cube with lit is refuted by propagation
+     **/
+    implied = 0;
+    if (!_ok) {
+        return false;
+    }
+    _cancel_until(0);
+
+    bool result = true;
+    for (size_t pos = 0; pos <= cube.size() && result; ++pos) {
+        Lit next = pos == cube.size() ? lit : cube[pos];
+        if (_lit_value(next) == 0) {
+            result = false;
+        } else if (_lit_value(next) < 0) {
+            size_t before = _trail.size();
+            _trail_lim.push_back(_trail.size());
+            _enqueue(next, clause_undef);
+            result = _propagate() == clause_undef;
+            if (pos == cube.size()) {
+                implied = _trail.size() - before;
+            }
+        }
+    }
+    _cancel_until(0);
+    return result;
+}
+
+void CdclSolver::set_stats(Stats* stats) {
+    _stats = stats;
+    _published_decisions = _decisions;
+    _published_conflicts = _conflicts;
+    _published_propagations = _propagations;
+}
+
+void CdclSolver::_publish_stats() {
+    /** counters since the last publication, so the copies of one solver add only their own work **/
+    if (_stats == nullptr) {
+        return;
+    }
+    _stats->decisions.fetch_add(_decisions - _published_decisions, std::memory_order_relaxed);
+    _stats->conflicts.fetch_add(_conflicts - _published_conflicts, std::memory_order_relaxed);
+    _stats->propagations.fetch_add(_propagations - _published_propagations, std::memory_order_relaxed);
+    _published_decisions = _decisions;
+    _published_conflicts = _conflicts;
+    _published_propagations = _propagations;
+}
+
+ValueEnum CdclSolver::solve(std::vector<Lit> const& assumptions) {
+    ValueEnum result = _search(assumptions);
+    _publish_stats();
+    return result;
+}
+
+ValueEnum CdclSolver::_search(std::vector<Lit> const& assumptions) {
+    /** assumptions are decided first, one per level, the learned clauses don't depend on them **/
+    if (!_ok) {
+        return ValueEnum::False;
+    }
+    _cancel_until(0);
+    if (!_import_shared()) {
+        return ValueEnum::False;
+    }
+    _max_learnts = std::max(min_learnts, _clauses.size() / 3);
+
+    std::vector<Lit> learnt;
+    uint64_t conflicts_limit = _conflict_budget == UINT64_MAX ? UINT64_MAX : _conflicts + _conflict_budget;
+    uint64_t conflicts_to_restart = static_cast<uint64_t>(luby(2, _restarts) * restart_unit);
+    uint64_t conflicts_since_restart = 0;
+
+    while (true) {
+        ClauseRef conflict = _propagate();
+
+        if (conflict != clause_undef) {
+            ++_conflicts;
+            ++conflicts_since_restart;
+            if (_decision_level() == 0) {
+                _ok = false;
+                return ValueEnum::False;
+            }
+            if (_conflicts >= conflicts_limit || (_stop != nullptr && _stop->load(std::memory_order_relaxed))) {
+                _cancel_until(0);
+                return ValueEnum::NotDetermined;
+            }
+
+            size_t backtrack_level;
+            uint32_t lbd;
+            _analyze(conflict, learnt, backtrack_level, lbd);
+            _cancel_until(backtrack_level);
+            if (_shared != nullptr && learnt.size() <= 2) {
+                _shared->publish(_shared_id, learnt);
+            }
+
+            if (learnt.size() == 1) {
+                _enqueue(learnt[0], clause_undef);
+            } else {
+                ClauseRef cref = _alloc_clause(learnt, true, lbd);
+                _learnts.push_back(cref);
+                _attach_clause(cref);
+                _bump_clause(cref);
+                _enqueue(learnt[0], cref);
+            }
+
+            _var_inc /= var_decay;
+            _clause_inc /= clause_decay;
+            continue;
+        }
+
+        if (conflicts_since_restart >= conflicts_to_restart) {
+            _cancel_until(0);
+            ++_restarts;
+            conflicts_since_restart = 0;
+            conflicts_to_restart = static_cast<uint64_t>(luby(2, _restarts) * restart_unit);
+            _publish_stats();
+            if (!_import_shared()) {
+                return ValueEnum::False;
+            }
+            continue;
+        }
+
+        if (_learnts.size() >= _max_learnts + _trail.size()) {
+            _reduce_db();
+            _max_learnts += _max_learnts / 10;
+        }
+
+        Lit decision = lit_undef;
+        while (_decision_level() < assumptions.size()) {
+            Lit assumption = assumptions[_decision_level()];
+            if (_lit_value(assumption) == 0) { // refuted under the assumptions, the formula itself may be SAT
+                _cancel_until(0);
+                return ValueEnum::False;
+            }
+            if (_lit_value(assumption) < 0) {
+                decision = assumption;
+                break;
+            }
+            _trail_lim.push_back(_trail.size()); // already True, keep one level per assumption
+        }
+
+        if (decision == lit_undef) {
+            decision = _pick_branch_lit();
+        }
+        if (decision == lit_undef) { // all variables are assigned without conflict
+            _model.resize(_assigns.size());
+            for (size_t var = 0; var != _assigns.size(); ++var) {
+                _model[var] = _assigns[var] == 1 ? ValueEnum::True : ValueEnum::False;
+            }
+            _cancel_until(0);
+            return ValueEnum::True;
+        }
+
+        ++_decisions;
+        _trail_lim.push_back(_trail.size());
+        _enqueue(decision, clause_undef);
+    }
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Circuit.h"
+#include "Stats.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using Var = int32_t;
+using Lit = int32_t;        // 2 * var + 1 if the literal is negative
+using ClauseRef = uint32_t; // offset of the clause in the clause arena
+
+constexpr Lit lit_undef = -1;
+constexpr ClauseRef clause_undef = UINT32_MAX;
+
+inline Lit make_lit(Var var, bool negative = false) {return 2 * var + static_cast<Lit>(negative);}
+inline Lit lit_neg(Lit lit)                         {return lit ^ 1;}
+inline Var lit_var(Lit lit)                         {return lit >> 1;}
+inline bool lit_sign(Lit lit)                       {return lit & 1;}
+
+double luby(double y, uint64_t x); // restart sequence shared by the clause-learning engines
+
+class SharedClauses {
+    /**
+     * Units and binary clauses learned by solvers that work on copies of the same formula, every solver
+     * publishes its short learned clauses and imports the ones of the others on restart
+     * @private_fields:
+     *      _clauses            -- [source solver, clause] in the order of publication
+     **/
+
+    public:
+        void publish(size_t source, std::vector<Lit> const& lits);
+        void collect(size_t source, size_t& cursor, std::vector<std::vector<Lit>>& clauses);
+
+    private:
+        std::mutex _mutex;
+        std::vector<std::pair<size_t, std::vector<Lit>>> _clauses;
+};
+
+class CdclSolver {
+    /**
+     * Conflict-driven clause-learning SAT solver
+     * @private_fields:
+     *      _arena              -- clauses stored one after another: [size, flags, activity, literals...]
+     *      _clauses            -- original clauses
+     *      _learnts            -- learned clauses, reduced by LBD and activity
+     *      _watches            -- two watched literals: clauses watching the literal, checked when it becomes False
+     *      _assigns            -- value of every variable (-1 -- not assigned, 0 -- False, 1 -- True)
+     *      _levels, _reasons   -- decision level of the variable and clause that implied it
+     *      _trail, _trail_lim  -- assigned literals in order and the trail size at the start of every level
+     *      _activity, _heap    -- VSIDS scores and binary heap of variables ordered by them
+     *      _polarity           -- saved phase of every variable
+     *
+     * @methods:
+     *      new_var             -- create variable
+     *      add_clause          -- add clause at level 0, returns false if the formula became UNSAT
+     *      solve               -- True (SAT), False (UNSAT under the assumptions),
+     *                             NotDetermined if the search was stopped from outside
+     *      probe               -- literals implied by the cube and one more literal, false on conflict
+     *      model_value         -- value of the variable in the found model
+     *      prioritize          -- make the variable the next one to decide
+     *      set_stop            -- flag checked on every conflict, solve gives up when it is set
+     *      set_conflict_budget -- conflicts allowed to one solve call, NotDetermined when they are exhausted
+     *      set_shared          -- exchange of units and binary clauses with other solvers
+     *      set_stats           -- decisions, conflicts and propagations are added to stats on every restart
+     *                             and at the end of solve, counted from the call of set_stats
+     **/
+
+    public:
+        Var new_var();
+        bool add_clause(std::vector<Lit> lits);
+        ValueEnum solve(std::vector<Lit> const& assumptions = {});
+        bool probe(std::vector<Lit> const& cube, Lit lit, size_t& implied);
+        void prioritize(Var var);
+
+        void set_stop(std::atomic<bool> const* stop)              {_stop = stop;}
+        void set_conflict_budget(uint64_t conflicts)              {_conflict_budget = conflicts;}
+        void set_shared(SharedClauses* shared, size_t id)         {_shared = shared; _shared_id = id; _shared_cursor = 0;}
+        void set_stats(Stats* stats);
+
+        [[nodiscard]] ValueEnum model_value(Var var) const {return _model.at(var);}
+        [[nodiscard]] bool is_ok()                       const {return _ok;}
+        [[nodiscard]] size_t get_vars_count()            const {return _assigns.size();}
+        [[nodiscard]] size_t get_clauses_count()         const {return _clauses.size();}
+        [[nodiscard]] uint64_t get_decisions()           const {return _decisions;}
+        [[nodiscard]] uint64_t get_conflicts()           const {return _conflicts;}
+        [[nodiscard]] uint64_t get_propagations()        const {return _propagations;}
+        [[nodiscard]] uint64_t get_restarts()            const {return _restarts;}
+
+    private:
+        struct Watcher {
+            ClauseRef cref;
+            Lit blocker;
+        };
+
+        // clause arena
+        static constexpr uint32_t header_size = 3;
+        static constexpr uint32_t flag_learnt = 1;
+        static constexpr uint32_t flag_deleted = 2;
+        ClauseRef _alloc_clause(std::vector<Lit> const& lits, bool learnt, uint32_t lbd);
+        uint32_t _clause_size(ClauseRef cref)     const {return _arena[cref];}
+        Lit* _clause_lits(ClauseRef cref)               {return reinterpret_cast<Lit*>(&_arena[cref + header_size]);}
+        bool _clause_learnt(ClauseRef cref)       const {return _arena[cref + 1] & flag_learnt;}
+        bool _clause_deleted(ClauseRef cref)      const {return _arena[cref + 1] & flag_deleted;}
+        uint32_t _clause_lbd(ClauseRef cref)      const {return _arena[cref + 1] >> 2;}
+        float _clause_activity(ClauseRef cref) const;
+        void _set_clause_activity(ClauseRef cref, float activity);
+
+        // assignment
+        int8_t _lit_value(Lit lit) const {
+            int8_t value = _assigns[lit_var(lit)];
+            return value < 0 ? value : static_cast<int8_t>(value ^ static_cast<int8_t>(lit_sign(lit)));
+        }
+        size_t _decision_level() const {return _trail_lim.size();}
+        void _enqueue(Lit lit, ClauseRef reason);
+        void _cancel_until(size_t level);
+        void _attach_clause(ClauseRef cref);
+        ClauseRef _propagate();
+
+        // conflict analysis
+        void _analyze(ClauseRef conflict, std::vector<Lit>& learnt, size_t& backtrack_level, uint32_t& lbd);
+        bool _literal_redundant(Lit lit);
+
+        // branching
+        void _bump_var(Var var);
+        void _bump_clause(ClauseRef cref);
+        void _heap_insert(Var var);
+        void _heap_up(size_t pos);
+        void _heap_down(size_t pos);
+        Var _heap_pop();
+        Lit _pick_branch_lit();
+
+        ValueEnum _search(std::vector<Lit> const& assumptions);
+        void _publish_stats();
+
+        // clause database
+        void _reduce_db();
+        void _collect_garbage();
+        bool _import_shared();
+
+        std::vector<uint32_t> _arena;
+        std::vector<ClauseRef> _clauses;
+        std::vector<ClauseRef> _learnts;
+        std::vector<std::vector<Watcher>> _watches;
+
+        std::vector<int8_t> _assigns;
+        std::vector<uint32_t> _levels;
+        std::vector<ClauseRef> _reasons;
+        std::vector<Lit> _trail;
+        std::vector<size_t> _trail_lim;
+        size_t _qhead = 0;
+
+        std::vector<double> _activity;
+        std::vector<Var> _heap;
+        std::vector<int32_t> _heap_index;
+        std::vector<bool> _polarity;
+        double _var_inc = 1.0;
+        float _clause_inc = 1.0f;
+
+        std::vector<uint8_t> _seen;
+        std::vector<ValueEnum> _model;
+        size_t _max_learnts = 0;
+        bool _ok = true;
+
+        std::atomic<bool> const* _stop = nullptr;
+        uint64_t _conflict_budget = UINT64_MAX;
+        SharedClauses* _shared = nullptr;
+        size_t _shared_id = 0;
+        size_t _shared_cursor = 0;
+
+        uint64_t _decisions = 0;
+        uint64_t _conflicts = 0;
+        uint64_t _propagations = 0;
+        uint64_t _restarts = 0;
+        Stats* _stats = nullptr;
+        uint64_t _published_decisions = 0;
+        uint64_t _published_conflicts = 0;
+        uint64_t _published_propagations = 0;
+};
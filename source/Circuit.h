@@ -1,11 +1,19 @@
 #pragma once
 
+#include "Aig.h"
+#include "BigCount.h"
+#include "Stats.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <map>
 
-enum class OperatorsEnum { /** gate operators */
+enum class OperatorsEnum : uint8_t { /** gate operators */
     UNKNOWN,
     INPUT,
     AND,
@@ -18,143 +26,352 @@ enum class OperatorsEnum { /** gate operators */
     BUFF
 };
 
-enum class ValueEnum { /** value gates */
+enum class ValueEnum : int8_t { /** value gates */
     NotDetermined = -1,
     False,
     True
 };
 
-using GateIdx = size_t;
+enum class EngineEnum { /** algorithm used by CircuitSAT::solve */
+    RECURSIVE,      // enumeration of the assignments of the inputs one by one
+    SIMULATION,     // bit-parallel simulation, 64/256/512 assignments per pass
+    CDCL,           // conflict-driven clause learning over the Tseitin encoding of the circuit
+    CIRCUIT,        // clause learning directly on the gate graph with a justification frontier
+    CUBE            // lookahead cubes conquered by CDCL solvers on a thread pool
+};
+
+enum class OutputsEnum { /** meaning of several OUTPUT lines for CircuitSAT::solve */
+    ANY,            // one objective: OR of the outputs
+    EACH,           // every output separately, incremental queries to one solver
+    ALL             // one objective: AND of the outputs
+};
+
+using GateIdx = uint32_t;
+using EdgeIdx = uint32_t;
 using VecGates = std::vector<GateIdx>;
 
-struct Gate {
+class ParseError : public std::runtime_error {
+    /** BENCH file that can't be read: missing, malformed line, no outputs or a gate used but never defined **/
+
+    public:
+        explicit ParseError(std::string const& message) : std::runtime_error(message) {};
+};
+
+class GateRange {
+    /** read-only view of consecutive gate indexes in the flat edge arrays of CircuitSAT **/
+
+    public:
+        GateRange(GateIdx const* begin, GateIdx const* end) : _begin(begin), _end(end) {};
+
+        [[nodiscard]] GateIdx const* begin()        const {return _begin;}
+        [[nodiscard]] GateIdx const* end()          const {return _end;}
+        [[nodiscard]] size_t size()                 const {return static_cast<size_t>(_end - _begin);}
+        [[nodiscard]] bool empty()                  const {return _begin == _end;}
+        [[nodiscard]] GateIdx operator[](size_t pos) const {return _begin[pos];}
+        [[nodiscard]] GateIdx at(size_t pos) const {
+            if (pos >= size()) {
+                throw std::out_of_range("GateRange::at");
+            }
+            return _begin[pos];
+        }
+
+    private:
+        GateIdx const* _begin;
+        GateIdx const* _end;
+};
+
+class NameTable {
     /**
-     * Struct to represent gate
+     * Gate names interned one after another in a single character arena
      * @private_fields:
-     *      _gate_name          -- gate name from file
-     *      _operand_indexes    -- gate operands
-     *      _children_indexes   -- indexes of gates that use the current gate as an operand
-     *      _gate_index         -- gate index in vector from CircuitSAT class
-     *      _operator_type      -- operator type (OperatorsEnum)
-     *      _value              -- the resulting value of the gate, after initializing the input gates and
-     *                             calculating the values of its operands
-     *      _used_by_output     -- effect of the gate on the result of the output
+     *      _chars              -- characters of all names without separators
+     *      _offsets            -- name of the gate i is _chars[_offsets[i] .. _offsets[i + 1])
+     **/
+
+    public:
+        NameTable() : _offsets{0} {};
+
+        [[nodiscard]] std::string_view get(size_t pos) const {
+            return {_chars.data() + _offsets.at(pos), static_cast<size_t>(_offsets.at(pos + 1) - _offsets.at(pos))};
+        }
+        [[nodiscard]] size_t size() const {return _offsets.size() - 1;}
+        [[nodiscard]] std::vector<char> const& get_chars()      const {return _chars;}
+        [[nodiscard]] std::vector<EdgeIdx> const& get_offsets() const {return _offsets;}
+
+        void append(std::string_view name) {
+            _chars.insert(_chars.end(), name.begin(), name.end());
+            _offsets.push_back(static_cast<EdgeIdx>(_chars.size()));
+        }
+        void clear() {
+            _chars.clear();
+            _offsets.assign(1, 0);
+        }
+        void assign(std::vector<char> chars, std::vector<EdgeIdx> offsets) { // offsets as returned by get_offsets
+            _chars = std::move(chars);
+            _offsets = std::move(offsets);
+        }
+        void compact(VecGates const& new_indexes) {
+            /** in place: the name i is kept if new_indexes[i] != UINT32_MAX, kept names move to the front **/
+            EdgeIdx begin = 0;
+            EdgeIdx chars_end = 0;
+            size_t kept = 0;
+            for (size_t pos = 0; pos + 1 < _offsets.size(); ++pos) {
+                EdgeIdx end = _offsets[pos + 1];
+                if (new_indexes[pos] != UINT32_MAX) {
+                    if (chars_end != begin) { // the names before were kept, nothing to move
+                        std::copy(_chars.begin() + begin, _chars.begin() + end, _chars.begin() + chars_end);
+                    }
+                    chars_end += end - begin;
+                    _offsets[++kept] = chars_end;
+                }
+                begin = end;
+            }
+            _chars.resize(chars_end);
+            _offsets.resize(kept + 1);
+        }
+
+    private:
+        std::vector<char> _chars;
+        std::vector<EdgeIdx> _offsets;
+};
+
+class CircuitSAT;
+
+class Gate {
+    /**
+     * Gate-like view of one gate of the flat circuit layout, valid while the circuit isn't changed
+     * @private_fields:
+     *      _circuit            -- circuit that stores the gate
+     *      _gate_index         -- gate index in CircuitSAT
      **/
 
     public:
-        Gate(
-            std::string gate_name,
-            GateIdx gate_index,
-            VecGates operand_indexes = {},
-            VecGates children_indexes = {},
-            OperatorsEnum operator_type = OperatorsEnum::UNKNOWN,
-            ValueEnum value = ValueEnum::NotDetermined,
-            ValueEnum used_by_output = ValueEnum::NotDetermined,
-            ValueEnum need_to_be_calculate = ValueEnum::NotDetermined
-
-        )
-          : _gate_name(std::move(gate_name))
-          , _operand_indexes(std::move(operand_indexes))
-          , _children_indexes(std::move(children_indexes))
-          , _gate_index(gate_index)
-          , _operator_type(operator_type)
-          , _value(value)
-          , _used_by_output(used_by_output)
-          , _need_to_be_calculate(need_to_be_calculate) {};
-
-        ~Gate() = default;
-
-        friend class CircuitSAT;
-
-        [[maybe_unused, nodiscard]] std::string const& get_name()   const {return _gate_name;}
-        [[nodiscard]] VecGates const& get_operand_indexes()         const {return _operand_indexes;}
-        [[nodiscard]] GateIdx get_operand_index(size_t pos)         const {return _operand_indexes.at(pos);}
-        [[nodiscard]] VecGates const& get_children_indexes()        const {return _children_indexes;}
+        Gate(CircuitSAT const& circuit, GateIdx gate_index) : _circuit(&circuit), _gate_index(gate_index) {};
+
+        [[maybe_unused, nodiscard]] std::string_view get_name()     const;
+        [[nodiscard]] GateRange get_operand_indexes()               const;
+        [[nodiscard]] GateIdx get_operand_index(size_t pos)         const {return get_operand_indexes().at(pos);}
+        [[nodiscard]] GateRange get_children_indexes()              const;
         [[nodiscard]] GateIdx get_gate_index()                      const {return _gate_index;}
-        [[nodiscard]] OperatorsEnum get_operator_type()             const {return _operator_type;}
-        [[nodiscard]] ValueEnum get_value()                         const {return _value;}
-        [[nodiscard]] ValueEnum get_status_calculate()              const {return _need_to_be_calculate;}
-        [[nodiscard]] ValueEnum get_used_by_output_value()          const {return _used_by_output;}
+        [[nodiscard]] OperatorsEnum get_operator_type()             const;
+        [[nodiscard]] ValueEnum get_value()                         const;
+        [[nodiscard]] ValueEnum get_used_by_output_value()          const;
 
     private:
-        void append_operand_index(GateIdx operand)                        {_operand_indexes.push_back(operand);}
-        void change_operand(size_t pos, GateIdx new_operand)              {_operand_indexes.at(pos) = new_operand;}
-        void append_child_index(GateIdx child)                            {_children_indexes.push_back(child);}
-        void set_operator(OperatorsEnum op)                               {_operator_type = op;}
-        void set_value(ValueEnum value)                                   {_value = value;}
-        void set_using(ValueEnum value)                                   {_used_by_output = value;}
-        void set_status_calculate(ValueEnum value)                        {_need_to_be_calculate = value;}
-        void set_index(GateIdx gate_index)                                {_gate_index = gate_index;}
-
-        std::string _gate_name;
-        VecGates _operand_indexes;
-        VecGates _children_indexes;
+        CircuitSAT const* _circuit;
         GateIdx _gate_index;
-        OperatorsEnum _operator_type;
-        ValueEnum _value;
-        ValueEnum _used_by_output;
-        ValueEnum _need_to_be_calculate;
 };
 
 class CircuitSAT {
     /**
-     * Struct to represent circuit
+     * Struct to represent circuit. Gates are stored as a struct of arrays, operands and children of all gates
+     * are kept in CSR form: operands of the gate i are _operand_edges[_operand_offsets[i] .. _operand_offsets[i + 1])
      * @fields:
      *     _input_gate_indexes  -- encoded name gate vector
-     *     _gates               -- vector of Gate
-     *     _output_index        -- encoded name output gate
+     *     _operators           -- operator type of every gate
+     *     _operand_offsets     -- CSR offsets of gate operands
+     *     _operand_edges       -- gate operands
+     *     _children_offsets    -- CSR offsets of gates that use the gate as an operand
+     *     _children_edges      -- gates that use the gate as an operand
+     *     _names               -- gate names from file
+     *     _original_inputs     -- names of the input gates in the order of declaration in the file, simplify
+     *                             doesn't change them, so a witness can be reported in terms of the file
+     *     _values              -- the resulting value of the gate, after initializing the input gates and
+     *                             calculating the values of its operands
+     *     _used_by_output      -- effect of the gate on the result of the output
+     *     _level_order         -- gates of the output cone sorted by level (input gates have level 0,
+     *                             a gate is one level above its highest operand), cached by levelize
+     *     _level_offsets       -- gates of level l are _level_order[_level_offsets[l] .. _level_offsets[l + 1])
+     *     _gate_levels         -- level of every gate, UINT32_MAX outside the output cone
+     *     _pending_edges       -- [gate, operand] pairs appended while parsing, moved to CSR by build_adjacency
+     *     _new_indexes         -- dense renaming of gates between _remove_unused_gates and _rename_gates
+     *     _output_index        -- encoded name output gate: the objective of solve. With several outputs in the
+     *                             ANY/ALL modes it is an OR/AND gate over them added by parse
+     *     _output_indexes      -- gates solved by solve: the declared outputs in the EACH mode, _output_index otherwise
+     *     _outputs_mode        -- meaning of several outputs, used by parse, simplify and solve
+     *     _output_results      -- result of every gate of _output_indexes after solve in the EACH mode or count
+     *     _output_counts       -- number of models of every gate of _output_indexes after count
+     *     _removed_by_rewriting -- gates removed by the AIG rewriting of the last simplify
+     *     _merged_by_sweeping  -- AIG nodes merged with an equivalent node by SAT sweeping in the last simplify
+     *     _parsed_gates_count  -- gates of the circuit right after parse, kept by the cache of load_simplified
+     *     _sweeping            -- simplify and the incremental solver merge equivalent gates by SAT sweeping
+     *     _engine              -- algorithm used by solve
+     *     _threads_count       -- threads used by solve (0 -- all cores)
+     *     _stop                -- flag set from outside to interrupt simplify and solve, nullptr -- never
+     *     _stats               -- counters and phase times collected by parse, simplify, solve and count,
+     *                             nullptr -- not collected
      *
      * @methods:
-     *     parse                -- parsing file
-     *     simplify             -- remove gates that do not affect the output or are a copy of another
-     *     solve                -- recursive full enumeration of possible values of input gates
-     *     show_result          -- result after solve circuit (SAT/UNSAT)
+     *     parse                -- parsing file, throws ParseError if the file can't be read as a circuit
+     *     levelize             -- compute the level order of the output cone, simplify calls it at the end
+     *     load_simplified      -- parse and simplify, or load the simplified circuit saved by an earlier run from
+     *                             the cache directory (a versioned binary file keyed by the content hash of the
+     *                             BENCH file and the outputs mode), true if it was loaded
+     *     simplify             -- remove gates that do not affect the output, merge gates with the same function
+     *                             by structural hashing of the AIG, local rewriting and SAT sweeping (within a
+     *                             budget, skipped for large graphs or if switched off by set_sweeping).
+     *                             In the EACH mode only the gates outside the cones of all outputs are removed,
+     *                             the combined cone is swept by the incremental solver of solve
+     *     solve                -- full enumeration of possible values of input gates with the selected engine
+     *                             (the EACH mode always uses the incremental CDCL solver). An AND/OR output over
+     *                             groups of operands with disjoint inputs is solved as independent parts,
+     *                             the output gate gets NotDetermined if the search was interrupted by _stop
+     *     count                -- exact number of assignments of the original inputs that set every gate of
+     *                             _output_indexes (one objective unless the mode is EACH), false if _stop was set
+     *     show_count           -- counts after count, "<output>=<count> ..." in the EACH mode, UNKNOWN if stopped
+     *     show_result          -- result after solve circuit (SAT/UNSAT/UNKNOWN), "<output>=<result> ..." in the EACH mode
+     *     get_witness          -- values of the original inputs after solve returned true, inputs removed by
+     *                             simplify don't affect the output and get False
+     *     write_witness        -- witness as text lines "<name> <0|1>" or binary: "CSW1", the number of inputs
+     *                             (uint32, little-endian), values packed 8 per byte starting from the lowest bit
+     *     check_witness        -- bit-parallel simulation of the circuit from the file on the witness, the outputs
+     *                             are combined as in the mode the witness was found in
+     *     gate_to_aig          -- AIG literal of a gate function over the literals of its operands
+     *     cone_to_aig          -- AIG literals of the gates of a cone, the graph can be extended by later cones
      **/
 
     public:
         // get fields in class CircuitSAT
         [[nodiscard]] VecGates const& get_input_gate_indexes() const {return _input_gate_indexes;}
-        [[nodiscard]] size_t get_input_gate_index(size_t pos)  const {return _input_gate_indexes.at(pos);}
-        [[nodiscard]] std::vector<Gate> const& get_gates()     const {return _gates;}
-        [[nodiscard]] Gate const& get_gate(size_t pos)         const {return _gates.at(pos);}
+        [[nodiscard]] GateIdx get_input_gate_index(size_t pos) const {return _input_gate_indexes.at(pos);}
+        [[nodiscard]] size_t get_gates_count()                 const {return _operators.size();}
+        [[nodiscard]] Gate get_gate(size_t pos)                const {return {*this, static_cast<GateIdx>(pos)};}
+        [[nodiscard]] GateIdx get_output_index()               const {return _output_index;}
+        [[nodiscard]] VecGates const& get_output_indexes()     const {return _output_indexes;}
+        [[nodiscard]] OutputsEnum get_outputs_mode()           const {return _outputs_mode;}
+        [[nodiscard]] std::vector<ValueEnum> const& get_output_results() const {return _output_results;}
+        [[nodiscard]] std::vector<BigCount> const& get_output_counts() const {return _output_counts;}
+        [[nodiscard]] EngineEnum get_engine()                  const {return _engine;}
+        [[nodiscard]] size_t get_threads_count()               const {return _threads_count;}
+        [[nodiscard]] size_t get_removed_by_rewriting()        const {return _removed_by_rewriting;}
+        [[nodiscard]] VecGates const& get_level_order()        const {return _level_order;}
+        [[nodiscard]] std::vector<EdgeIdx> const& get_level_offsets() const {return _level_offsets;}
+        [[nodiscard]] uint32_t get_gate_level(size_t pos)      const {return _gate_levels.at(pos);}
+        [[nodiscard]] size_t get_merged_by_sweeping()          const {return _merged_by_sweeping;}
+        [[nodiscard]] size_t get_parsed_gates_count()          const {return _parsed_gates_count;}
+        [[nodiscard]] bool get_sweeping()                      const {return _sweeping;}
+        [[nodiscard]] std::atomic<bool> const* get_stop()      const {return _stop;}
+        [[nodiscard]] Stats* get_stats()                       const {return _stats;}
+        [[nodiscard]] NameTable const& get_original_inputs()   const {return _original_inputs;}
 
         // set fields in class CircuitSAT
         void append_input_gate(GateIdx idx)                          {_input_gate_indexes.push_back(idx);}
-        void append_gates(Gate&& gate)                               {_gates.push_back(std::move(gate));}
+        GateIdx append_gate(std::string_view name);
+        void build_adjacency();
         void set_idx_output(GateIdx idx)                             {_output_index = idx;}
+        void set_engine(EngineEnum engine)                           {_engine = engine;}
+        void set_outputs_mode(OutputsEnum mode)                      {_outputs_mode = mode;} // before parse
+        void set_threads_count(size_t threads_count)                 {_threads_count = threads_count;}
+        void set_sweeping(bool sweeping)                             {_sweeping = sweeping;} // before simplify
+        void set_stop(std::atomic<bool> const* stop)                 {_stop = stop;}
+        void set_stats(Stats* stats)                                 {_stats = stats;}
 
         // delete fields in class CircuitSAT
         void clear_input_gate_indexes()                              {_input_gate_indexes={};}
 
-        // set fields in struct Gate
-        void append_gate_operand_index(size_t pos, GateIdx operand)  {_gates.at(pos).append_operand_index(operand);}
-        void change_gate_operand(size_t pos, size_t pos_op, size_t new_op)
-                                                                     {_gates.at(pos).change_operand(pos_op, new_op);}
-        void append_gate_child_index(size_t pos, GateIdx child)      {_gates.at(pos).append_child_index(child);}
-        void set_gate_index(size_t pos, GateIdx new_idx)             {_gates.at(pos).set_index(new_idx);}
-        void set_gate_operator(size_t pos, OperatorsEnum op)         {_gates.at(pos).set_operator(op);}
-        void set_gate_value(size_t pos, ValueEnum value)             {_gates.at(pos).set_value(value);}
-        void set_gate_using(size_t pos, ValueEnum value)             {_gates.at(pos).set_using(value);}
-        void set_gate_status_calculate(size_t pos, ValueEnum value)  {_gates.at(pos).set_status_calculate(value);}
+        // set fields of the gates
+        void append_gate_operand_index(size_t pos, GateIdx operand)  {_pending_edges.emplace_back(pos, operand);}
+        void change_gate_operand(size_t pos, size_t pos_op, GateIdx new_op)
+                                                                     {_operand_edges.at(_operand_offsets.at(pos) + pos_op) = new_op;}
+        void set_gate_operator(size_t pos, OperatorsEnum op)         {_operators.at(pos) = op;}
+        void set_gate_value(size_t pos, ValueEnum value)             {_values.at(pos) = value;}
+        void set_gate_using(size_t pos, ValueEnum value)             {_used_by_output.at(pos) = value;}
 
         // functions to solve the circuit
         void parse(std::string const& path);
+        void levelize();
         void simplify();
+        bool load_simplified(std::string const& path, std::string const& cache_dir);
         bool solve();
+        bool count();
+        [[nodiscard]] std::string show_count() const;
         [[nodiscard]] std::string show_result() const;
+        [[nodiscard]] std::vector<bool> get_witness() const;
+        [[nodiscard]] bool write_witness(std::string const& path, bool binary) const;
+        static bool check_witness(std::string const& bench_path, std::vector<bool> const& witness,
+                                  OutputsEnum mode = OutputsEnum::ANY);
+
+        // conversion to an And-Inverter Graph
+        static AigLit gate_to_aig(Aig& aig, OperatorsEnum op, std::vector<AigLit> const& operand_lits);
+        void cone_to_aig(Aig& aig, std::vector<AigLit>& gate_lits, GateIdx root) const;
 
         friend struct Operators;
+        friend class Gate;
 
     private:
-        bool _solve(size_t pos_input_gate, ValueEnum value);
+        ValueEnum _solve();
+        ValueEnum _solve_enumeration();
+        bool _evaluate();
+        ValueEnum _solve_simulation();
+        ValueEnum _solve_cdcl();
+        ValueEnum _solve_circuit();
+        ValueEnum _solve_cube();
+        ValueEnum _solve_each_output();
+        bool _solve_parts(ValueEnum& result);
+        void _extract_part(VecGates const& roots, OperatorsEnum op, bool value, CircuitSAT& part) const;
+        [[nodiscard]] bool _is_stopped() const {return _stop != nullptr && _stop->load(std::memory_order_relaxed);}
         void _backpropagation_to_use(GateIdx idx);
-        void _replace_copy_gates();
+        void _rewrite_aig();
+        bool _rebuild_from_aig(Aig const& aig, AigLit root, std::vector<AigLit> const& gate_lits);
         void _remove_unused_gates();
         void _rename_gates();
+        void _build_children();
+        bool _save_cache(std::string const& cache_path, uint64_t source_hash) const;
+        bool _load_cache(std::string const& cache_path, uint64_t source_hash);
 
         VecGates _input_gate_indexes;
-        std::vector<Gate> _gates;
+        std::vector<OperatorsEnum> _operators;
+        std::vector<EdgeIdx> _operand_offsets{0};
+        VecGates _operand_edges;
+        std::vector<EdgeIdx> _children_offsets{0};
+        VecGates _children_edges;
+        NameTable _names;
+        NameTable _original_inputs;
+        std::vector<ValueEnum> _values;
+        std::vector<ValueEnum> _used_by_output;
+        VecGates _level_order;
+        std::vector<EdgeIdx> _level_offsets;
+        std::vector<uint32_t> _gate_levels;
+        std::vector<std::pair<GateIdx, GateIdx>> _pending_edges;
+        VecGates _new_indexes;
         GateIdx _output_index = 0;
+        VecGates _output_indexes;
+        OutputsEnum _outputs_mode = OutputsEnum::ANY;
+        std::vector<ValueEnum> _output_results;
+        std::vector<BigCount> _output_counts;
+        size_t _removed_by_rewriting = 0;
+        size_t _merged_by_sweeping = 0;
+        size_t _parsed_gates_count = 0;
+        bool _sweeping = true;
+        EngineEnum _engine = EngineEnum::RECURSIVE;
+        size_t _threads_count = 1;
+        std::atomic<bool> const* _stop = nullptr;
+        Stats* _stats = nullptr;
 
 };
 
+inline std::string_view Gate::get_name() const {
+    return _circuit->_names.get(_gate_index);
+}
+
+inline GateRange Gate::get_operand_indexes() const {
+    GateIdx const* edges = _circuit->_operand_edges.data();
+    return {edges + _circuit->_operand_offsets.at(_gate_index), edges + _circuit->_operand_offsets.at(_gate_index + 1)};
+}
+
+inline GateRange Gate::get_children_indexes() const {
+    GateIdx const* edges = _circuit->_children_edges.data();
+    return {edges + _circuit->_children_offsets.at(_gate_index), edges + _circuit->_children_offsets.at(_gate_index + 1)};
+}
+
+inline OperatorsEnum Gate::get_operator_type() const {
+    return _circuit->_operators.at(_gate_index);
+}
+
+inline ValueEnum Gate::get_value() const {
+    return _circuit->_values.at(_gate_index);
+}
+
+inline ValueEnum Gate::get_used_by_output_value() const {
+    return _circuit->_used_by_output.at(_gate_index);
+}
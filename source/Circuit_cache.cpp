@@ -0,0 +1,288 @@
+#include "Circuit.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+constexpr char cache_magic[8] = {'C', 'S', 'C', 'A', 'C', 'H', 'E', '\0'};
+constexpr uint32_t cache_version = 2;   // changes with the layout of the file and with the passes of simplify
+
+constexpr std::string_view mode_names[] = {"any", "each", "all"}; /** names of OutputsEnum in the cache file names **/
+
+uint64_t content_hash(std::string_view data) {
+    /**
+     * multiply-xorshift hash of 8-byte words in four independent lanes, so the hash of a large file runs at
+     * memory speed; the tail bytes and the length are mixed in at the end
+     **/
+    uint64_t const prime = 0x9E3779B97F4A7C15ULL;
+    auto mix = [prime](uint64_t hash, uint64_t word) {
+        hash = (hash ^ word) * prime;
+        return hash ^ (hash >> 29);
+    };
+    uint64_t lanes[4] = {1, 2, 3, 4};
+    size_t pos = 0;
+    for (; pos + 32 <= data.size(); pos += 32) {
+        for (size_t lane = 0; lane != 4; ++lane) {
+            uint64_t word = 0;
+            std::memcpy(&word, data.data() + pos + 8 * lane, 8);
+            lanes[lane] = mix(lanes[lane], word);
+        }
+    }
+    uint64_t hash = mix(mix(mix(mix(data.size(), lanes[0]), lanes[1]), lanes[2]), lanes[3]);
+    for (; pos < data.size(); pos += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, data.data() + pos, std::min<size_t>(8, data.size() - pos));
+        hash = mix(hash, word);
+    }
+    return mix(hash, prime);
+}
+
+template <class T>
+void append(std::string& buffer, T const& value) {
+    buffer.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template <class T>
+void append(std::string& buffer, std::vector<T> const& values) {
+    /** section: the number of elements, the elements, zero padding to 8 bytes **/
+    append(buffer, static_cast<uint64_t>(values.size()));
+    buffer.append(reinterpret_cast<char const*>(values.data()), values.size() * sizeof(T));
+    buffer.resize((buffer.size() + 7) / 8 * 8, '\0');
+}
+
+class CacheReader {
+    /** sections of a mapped cache file read in the order they were appended, every read checks the bounds **/
+
+    public:
+        explicit CacheReader(std::string_view data) : _data(data) {};
+
+        template <class T>
+        bool read(T& value) {
+            if (_data.size() - _pos < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, _data.data() + _pos, sizeof(T));
+            _pos += sizeof(T);
+            return true;
+        }
+
+        template <class T>
+        bool read(std::vector<T>& values) {
+            uint64_t count = 0;
+            if (!read(count) || count > (_data.size() - _pos) / sizeof(T)) {
+                return false;
+            }
+            size_t bytes = static_cast<size_t>(count) * sizeof(T);
+            size_t padded = (bytes + 7) / 8 * 8;
+            if (padded > _data.size() - _pos) {
+                return false;
+            }
+            values.resize(static_cast<size_t>(count));
+            std::memcpy(values.data(), _data.data() + _pos, bytes);
+            _pos += padded;
+            return true;
+        }
+
+        [[nodiscard]] bool at_end() const {return _pos == _data.size();}
+
+    private:
+        std::string_view _data;
+        size_t _pos = 0;
+};
+
+bool valid_offsets(std::vector<EdgeIdx> const& offsets, size_t count, size_t edges) {
+    /** CSR offsets of count rows over edges elements **/
+    if (offsets.size() != count + 1 || offsets.front() != 0 || offsets.back() != edges) {
+        return false;
+    }
+    for (size_t pos = 0; pos != count; ++pos) {
+        if (offsets[pos] > offsets[pos + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool valid_indexes(VecGates const& indexes, size_t gates_count) {
+    for (GateIdx gate : indexes) {
+        if (gate >= gates_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool CircuitSAT::load_simplified(std::string const& path, std::string const& cache_dir) {
+    /**
+     * the cache file is named by the content hash of the BENCH file, the outputs mode and "-nosweep" if SAT
+     * sweeping is switched off, the hash is also checked against the header, so an edited file gets a new entry
+     * and a stale one is never loaded.
+     * A simplify interrupted by _stop is not cached, its result may be simplified less than usual
+     **/
+    std::string cache_path;
+    uint64_t source_hash = 0;
+    if (!cache_dir.empty()) {
+        PhaseTimer timer(_stats, PhaseEnum::CACHE);
+        MappedFile bench_file(path);
+        if (bench_file.is_open()) {
+            source_hash = content_hash(bench_file.view());
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(source_hash));
+            cache_path = (std::filesystem::path(cache_dir) /
+                          (name + ("-" + std::string(mode_names[static_cast<size_t>(_outputs_mode)])) +
+                           (_sweeping ? "" : "-nosweep") + ".csc")).string();
+            if (_load_cache(cache_path, source_hash)) {
+                return true;
+            }
+        }
+    }
+
+    parse(path);
+    simplify();
+    if (!cache_path.empty() && !_is_stopped()) {
+        PhaseTimer timer(_stats, PhaseEnum::CACHE);
+        _save_cache(cache_path, source_hash);
+    }
+    return false;
+}
+
+bool CircuitSAT::_save_cache(std::string const& cache_path, uint64_t source_hash) const {
+    /**
+     * the file is formatted in one buffer and written under a temporary name, then renamed: concurrent runs
+     * on the same circuit never see a partially written file
+     **/
+    std::string buffer(cache_magic, sizeof(cache_magic));
+    append(buffer, cache_version);
+    append(buffer, static_cast<uint32_t>(_outputs_mode));
+    append(buffer, static_cast<uint64_t>(_sweeping));
+    append(buffer, source_hash);
+    append(buffer, static_cast<uint64_t>(_parsed_gates_count));
+    append(buffer, static_cast<uint64_t>(_output_index));
+    append(buffer, static_cast<uint64_t>(_removed_by_rewriting));
+    append(buffer, static_cast<uint64_t>(_merged_by_sweeping));
+    append(buffer, _operators);
+    append(buffer, _operand_offsets);
+    append(buffer, _operand_edges);
+    append(buffer, _children_offsets);
+    append(buffer, _children_edges);
+    append(buffer, _input_gate_indexes);
+    append(buffer, _output_indexes);
+    append(buffer, _level_order);
+    append(buffer, _level_offsets);
+    append(buffer, _gate_levels);
+    append(buffer, _names.get_chars());
+    append(buffer, _names.get_offsets());
+    append(buffer, _original_inputs.get_chars());
+    append(buffer, _original_inputs.get_offsets());
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cache_path).parent_path(), error);
+    std::string temp_path = cache_path + ".tmp" + std::to_string(getpid()) + "_" +
+                            std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!out) {
+            out.close();
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, cache_path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
+
+bool CircuitSAT::_load_cache(std::string const& cache_path, uint64_t source_hash) {
+    /**
+     * the sections are copied from the mapping as they are; the circuit is changed only if the header matches
+     * and the arrays are consistent, so a truncated or foreign file is a cache miss, not a crash
+     **/
+    MappedFile cache_file(cache_path);
+    if (!cache_file.is_open() || cache_file.size() < sizeof(cache_magic) ||
+        std::memcmp(cache_file.data(), cache_magic, sizeof(cache_magic)) != 0) {
+        return false;
+    }
+    CacheReader reader(cache_file.view().substr(sizeof(cache_magic)));
+    uint32_t version = 0;
+    uint32_t mode = 0;
+    uint64_t sweeping = 0;
+    uint64_t hash = 0;
+    uint64_t parsed_gates_count = 0;
+    uint64_t output_index = 0;
+    uint64_t removed_by_rewriting = 0;
+    uint64_t merged_by_sweeping = 0;
+    if (!reader.read(version) || version != cache_version || !reader.read(mode) ||
+        mode != static_cast<uint32_t>(_outputs_mode) || !reader.read(sweeping) ||
+        sweeping != static_cast<uint64_t>(_sweeping) || !reader.read(hash) || hash != source_hash ||
+        !reader.read(parsed_gates_count) || !reader.read(output_index) || !reader.read(removed_by_rewriting) ||
+        !reader.read(merged_by_sweeping)) {
+        return false;
+    }
+
+    std::vector<OperatorsEnum> operators;
+    std::vector<EdgeIdx> operand_offsets, children_offsets, level_offsets, name_offsets, input_name_offsets;
+    VecGates operand_edges, children_edges, input_gate_indexes, output_indexes, level_order;
+    std::vector<uint32_t> gate_levels;
+    std::vector<char> name_chars, input_name_chars;
+    if (!reader.read(operators) || !reader.read(operand_offsets) || !reader.read(operand_edges) ||
+        !reader.read(children_offsets) || !reader.read(children_edges) || !reader.read(input_gate_indexes) ||
+        !reader.read(output_indexes) || !reader.read(level_order) || !reader.read(level_offsets) ||
+        !reader.read(gate_levels) || !reader.read(name_chars) || !reader.read(name_offsets) ||
+        !reader.read(input_name_chars) || !reader.read(input_name_offsets) || !reader.at_end()) {
+        return false;
+    }
+
+    size_t gates_count = operators.size();
+    for (OperatorsEnum op : operators) {
+        if (op == OperatorsEnum::UNKNOWN || op > OperatorsEnum::BUFF) {
+            return false;
+        }
+    }
+    bool levelized = _outputs_mode != OutputsEnum::EACH; // simplify doesn't levelize in the EACH mode
+    if (!valid_offsets(operand_offsets, gates_count, operand_edges.size()) ||
+        !valid_offsets(children_offsets, gates_count, children_edges.size()) ||
+        !valid_offsets(name_offsets, gates_count, name_chars.size()) ||
+        input_name_offsets.empty() ||
+        !valid_offsets(input_name_offsets, input_name_offsets.size() - 1, input_name_chars.size()) ||
+        !valid_indexes(operand_edges, gates_count) || !valid_indexes(children_edges, gates_count) ||
+        !valid_indexes(input_gate_indexes, gates_count) || !valid_indexes(output_indexes, gates_count) ||
+        !valid_indexes(level_order, gates_count) || output_index >= gates_count || output_indexes.empty() ||
+        (levelized && (level_order.empty() || gate_levels.size() != gates_count || level_offsets.size() < 2 ||
+                       !valid_offsets(level_offsets, level_offsets.size() - 1, level_order.size())))) {
+        return false;
+    }
+
+    _operators = std::move(operators);
+    _operand_offsets = std::move(operand_offsets);
+    _operand_edges = std::move(operand_edges);
+    _children_offsets = std::move(children_offsets);
+    _children_edges = std::move(children_edges);
+    _input_gate_indexes = std::move(input_gate_indexes);
+    _output_indexes = std::move(output_indexes);
+    _level_order = std::move(level_order);
+    _level_offsets = std::move(level_offsets);
+    _gate_levels = std::move(gate_levels);
+    _names.assign(std::move(name_chars), std::move(name_offsets));
+    _original_inputs.assign(std::move(input_name_chars), std::move(input_name_offsets));
+    _values.assign(gates_count, ValueEnum::NotDetermined);
+    _used_by_output.assign(gates_count, ValueEnum::True);
+    _pending_edges.clear();
+    _new_indexes.clear();
+    _output_index = static_cast<GateIdx>(output_index);
+    _parsed_gates_count = static_cast<size_t>(parsed_gates_count);
+    _removed_by_rewriting = static_cast<size_t>(removed_by_rewriting);
+    _merged_by_sweeping = static_cast<size_t>(merged_by_sweeping);
+    return true;
+}
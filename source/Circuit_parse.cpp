@@ -1,125 +1,258 @@
 #include "Circuit.h"
-#include <iostream>
-#include <fstream>
+#include "MappedFile.h"
+#include "NameIndex.h"
 #include <algorithm>
-#include <map>
-#include <cassert>
-
-constexpr size_t len_input = 6;  // "INPUT("
-constexpr size_t len_output = 7; // "OUTPUT("
-
-using OperMap = std::map<std::string, OperatorsEnum>;
-inline OperatorsEnum str_to_enum_operator(const std::string& str) {
-    static OperMap str_to_enum { /** encode string to enum **/
-            {"INPUT", OperatorsEnum::INPUT},
-            {"AND"  , OperatorsEnum::AND},
-            {"OR"   , OperatorsEnum::OR},
-            {"NOT"  , OperatorsEnum::NOT},
-            {"XOR"  , OperatorsEnum::XOR},
-            {"NAND" , OperatorsEnum::NAND},
-            {"NOR"  , OperatorsEnum::NOR},
-            {"NXOR" , OperatorsEnum::NXOR},
-            {"BUFF" , OperatorsEnum::BUFF}
-        };
-
-    return str_to_enum.at(str);
+#include <cstring>
+
+namespace {
+
+constexpr std::pair<std::string_view, OperatorsEnum> operator_names[] = { /** encode string to enum **/
+        {"INPUT", OperatorsEnum::INPUT},
+        {"AND"  , OperatorsEnum::AND},
+        {"OR"   , OperatorsEnum::OR},
+        {"NOT"  , OperatorsEnum::NOT},
+        {"XOR"  , OperatorsEnum::XOR},
+        {"NAND" , OperatorsEnum::NAND},
+        {"NOR"  , OperatorsEnum::NOR},
+        {"NXOR" , OperatorsEnum::NXOR},
+        {"BUFF" , OperatorsEnum::BUFF}
+};
+
+inline bool str_to_enum_operator(std::string_view str, OperatorsEnum& op) {
+    for (auto const& [name, value] : operator_names) {
+        if (name == str) {
+            op = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool is_space(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
 }
 
-void str_trim(std::string& line) { /** easy file preprocessing: remove whitespace */
-    line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
+inline bool is_delimiter(char ch) {
+    return ch == '(' || ch == ')' || ch == ',' || ch == '=' || ch == '#' || is_space(ch);
 }
 
-std::string substr_between_brackets(std::string str) { /** name of gate that is between the brackets */
-    int start_index = 0;
-    for (; str[start_index] != '('; ++start_index) {}
+struct LineCursor {
+    /** tokenizer over one line of the mapped file, tokens are views into the file **/
+    char const* pos;
+    char const* end;
 
-    int end_index = start_index + 1;
-    for (; str[end_index] != ')'; ++end_index) {}
+    void skip_spaces() {
+        for (; pos != end && is_space(*pos); ++pos) {}
+    }
+
+    [[nodiscard]] bool done() const {return pos == end;}
+
+    std::string_view read_name() { /** name or operator: everything up to a delimiter **/
+        skip_spaces();
+        char const* start = pos;
+        for (; pos != end && !is_delimiter(*pos); ++pos) {}
+        return {start, static_cast<size_t>(pos - start)};
+    }
+
+    bool accept(char ch) {
+        skip_spaces();
+        if (pos != end && *pos == ch) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+};
 
-    return str.substr(start_index + 1, end_index - start_index - 1);
+[[noreturn]] void parse_error(char const* begin, char const* end) {
+    throw ParseError("I cant read it: " + std::string(begin, end));
 }
 
-void CircuitSAT::parse(std::string const& path) { /** parsing file **/
-    std::ifstream bench_file(path);
-    assert(bench_file.is_open() && "Failed to open Bench file");
+} // namespace
 
-    std::string line;
-    std::string output_name = "UNTITLED";
-    std::map<std::string, GateIdx> map_gates; // [name_gates -> number_gates]
-    GateIdx num_gates = 0;
+void CircuitSAT::parse(std::string const& path) {
+    /** parsing file: the file is memory-mapped and tokenized in place, names are interned through NameIndex **/
+    PhaseTimer timer(_stats, PhaseEnum::PARSE);
+    MappedFile bench_file(path);
+    if (!bench_file.is_open()) {
+        throw ParseError("Failed to open Bench file: " + path);
+    }
 
-    while (getline(bench_file, line))
-    {
-        str_trim(line);
-        if (line.length() == 0 || line[0] == '#') { // comment in the file
-            continue;
+    std::vector<std::string_view> output_names;
+    NameIndex map_gates(bench_file.size() / 16); // [name_gates -> number_gates]
+
+    auto gate_index = [&](std::string_view name) { // create new gate if we haven't seen it yet
+        uint64_t name_hash = NameIndex::hash(name);
+        GateIdx index = map_gates.find(name, name_hash, *this);
+        if (index == NameIndex::not_found) {
+            index = append_gate(name);
+            map_gates.insert(name_hash, index);
         }
+        return index;
+    };
 
-        if (line.size() > len_input && line.substr(0, len_input) == "INPUT(") {
+    char const* pos = bench_file.data();
+    char const* file_end = pos + bench_file.size();
+    while (pos != file_end) {
+        char const* line_end = static_cast<char const*>(std::memchr(pos, '\n', static_cast<size_t>(file_end - pos)));
+        if (line_end == nullptr) {
+            line_end = file_end;
+        }
+        LineCursor line{pos, line_end};
+        pos = line_end == file_end ? file_end : line_end + 1;
 
-            std::string input_name = substr_between_brackets(line);
+        line.skip_spaces();
+        if (line.done() || *line.pos == '#') { // comment in the file
+            continue;
+        }
+        std::string_view first = line.read_name();
 
-            if (map_gates.find(input_name) == map_gates.end()) { // create new gate if we haven't seen it yet
-                map_gates[input_name] = num_gates;
-                append_gates(Gate(input_name, num_gates));
-                ++num_gates;
+        if (line.accept('(') && (first == "INPUT" || first == "OUTPUT")) {
+            std::string_view name = line.read_name();
+            if (name.empty() || !line.accept(')')) {
+                parse_error(first.data(), line_end);
             }
 
-            GateIdx input_index = map_gates[input_name];
-            append_input_gate(input_index); // store the encoded name
-            set_gate_operator(input_index, str_to_enum_operator("INPUT"));
-            
-        } else if (line.size() > len_output && line.substr(0, len_output) == "OUTPUT(") {
-
-            assert(output_name == "UNTITLED" && "You have more than one output");
-            output_name = substr_between_brackets(line); // store the output name. We initialize at the end of
-            // the function, after reading its operator and operands
-
-        } else if (line.find('=') != std::string::npos) {
-
-            // Read line by character, filling in the class structure along the way
-            size_t start_index = 0;
-            size_t end_index = 0;
-
-            // gate name
-            for(; line[end_index] != '='; ++end_index) {}
-            std::string gate_name = line.substr(start_index, end_index);
-            if (map_gates.find(gate_name) == map_gates.end()) { // create new gate
-                map_gates[gate_name] = num_gates;
-                append_gates(Gate(gate_name, num_gates));
-                ++num_gates;
+            if (first == "INPUT") {
+                GateIdx input_index = gate_index(name);
+                append_input_gate(input_index); // store the encoded name
+                set_gate_operator(input_index, OperatorsEnum::INPUT);
+            } else {
+                // store the output name. We initialize at the end of the function, after reading its operator
+                output_names.push_back(name);
             }
-            start_index = end_index + 1;
-
-            // operator
-            for(; line[end_index] != '('; ++end_index) {}
-            std::string operator_name = line.substr(start_index, end_index - start_index);
-
-            set_gate_operator(map_gates[gate_name], str_to_enum_operator(operator_name));
-            start_index = end_index + 1;
-
-            // operands
-            for(; end_index != line.size() && line[end_index] != '#'; ++end_index){
-                if (line[end_index] == ',' || line[end_index] == ')'){
-
-                    std::string operand = line.substr(start_index, end_index - start_index);
-                    if (map_gates.find(operand) == map_gates.end()){ // create new gate
-                        map_gates[operand] = num_gates;
-                        append_gates(Gate(operand, num_gates));
-                        ++num_gates;
-                    }
-                    append_gate_operand_index(map_gates[gate_name], map_gates[operand]);
-                    append_gate_child_index(map_gates[operand], map_gates[gate_name]);
-                    start_index = end_index + 1;
+
+        } else if (!first.empty() && line.accept('=')) {
+
+            GateIdx gate = gate_index(first);
+            OperatorsEnum op;
+            if (!str_to_enum_operator(line.read_name(), op) || !line.accept('(')) {
+                parse_error(first.data(), line_end);
+            }
+            set_gate_operator(gate, op);
+
+            do {
+                std::string_view operand = line.read_name();
+                if (operand.empty()) {
+                    parse_error(first.data(), line_end);
                 }
+                append_gate_operand_index(gate, gate_index(operand));
+            } while (line.accept(','));
+
+            if (!line.accept(')')) {
+                parse_error(first.data(), line_end);
             }
 
         } else {
-            std::cerr << "I cant read it: " + line << std::endl;
-            exit(1);
+            parse_error(first.data(), line_end);
+        }
+    }
+
+    if (output_names.empty()) {
+        throw ParseError("You haven't got output: " + path);
+    }
+    _output_indexes.clear();
+    for (std::string_view name : output_names) { // store the encoded output names, repeated outputs once
+        GateIdx output = gate_index(name);
+        if (std::find(_output_indexes.begin(), _output_indexes.end(), output) == _output_indexes.end()) {
+            _output_indexes.push_back(output);
+        }
+    }
+    for (size_t gate = 0; gate != get_gates_count(); ++gate) { // after the outputs: an undefined output too
+        if (_operators[gate] == OperatorsEnum::UNKNOWN) {
+            throw ParseError("Gate is used but not defined: " + std::string(get_gate(gate).get_name()));
         }
     }
+    set_idx_output(_output_indexes[0]);
+    if (_output_indexes.size() > 1 && _outputs_mode != OutputsEnum::EACH) {
+        // one objective over all outputs, the engines and simplify see a single-output circuit
+        bool any = _outputs_mode == OutputsEnum::ANY;
+        GateIdx objective = append_gate(any ? "outputs$any" : "outputs$all");
+        set_gate_operator(objective, any ? OperatorsEnum::OR : OperatorsEnum::AND);
+        for (GateIdx output : _output_indexes) {
+            append_gate_operand_index(objective, output);
+        }
+        set_idx_output(objective);
+        _output_indexes.assign(1, objective);
+    }
+    build_adjacency();
+
+    _original_inputs.clear();
+    for (GateIdx input : _input_gate_indexes) {
+        _original_inputs.append(get_gate(input).get_name());
+    }
+    _parsed_gates_count = get_gates_count();
+}
+
+GateIdx CircuitSAT::append_gate(std::string_view name) { /** new gate without operator and operands **/
+    GateIdx index = static_cast<GateIdx>(_operators.size());
+    _operators.push_back(OperatorsEnum::UNKNOWN);
+    _operand_offsets.push_back(_operand_offsets.back());
+    _children_offsets.push_back(_children_offsets.back());
+    _names.append(name);
+    _values.push_back(ValueEnum::NotDetermined);
+    _used_by_output.push_back(ValueEnum::NotDetermined);
+    return index;
+}
 
-    assert(output_name != "UNTITLED" && "You haven't got output");
-    set_idx_output(map_gates[output_name]); // store the encoded output name
+void CircuitSAT::build_adjacency() {
+    /**
+     * move the operands appended by append_gate_operand_index into the CSR arrays after the operands
+     * the gates already have (counting sort, the order of operands is kept) and rebuild the children
+     **/
+    _level_order.clear(); // the cached order is computed again by levelize
+    size_t gates_count = get_gates_count();
+    std::vector<EdgeIdx> offsets(gates_count + 1, 0);
+    for (size_t gate = 0; gate != gates_count; ++gate) {
+        offsets[gate + 1] = _operand_offsets[gate + 1] - _operand_offsets[gate];
+    }
+    for (auto const& [gate, operand] : _pending_edges) {
+        ++offsets[gate + 1];
+    }
+    for (size_t gate = 0; gate != gates_count; ++gate) {
+        offsets[gate + 1] += offsets[gate];
+    }
+
+    VecGates edges(offsets.back());
+    std::vector<EdgeIdx> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t gate = 0; gate != gates_count; ++gate) {
+        for (EdgeIdx pos = _operand_offsets[gate]; pos != _operand_offsets[gate + 1]; ++pos) {
+            edges[fill[gate]++] = _operand_edges[pos];
+        }
+    }
+    for (auto const& [gate, operand] : _pending_edges) {
+        edges[fill[gate]++] = operand;
+    }
+
+    _operand_offsets = std::move(offsets);
+    _operand_edges = std::move(edges);
+    _pending_edges.clear();
+    _pending_edges.shrink_to_fit();
+    _build_children();
+}
+
+void CircuitSAT::_build_children() {
+    /**
+     * children lists are the transposed operand lists. The offsets serve as the fill positions: after the fill
+     * the offset of every gate is the end of its list, shifting them by one position gives the beginnings
+     **/
+    size_t gates_count = get_gates_count();
+    _children_offsets.assign(gates_count + 1, 0);
+    for (GateIdx operand : _operand_edges) {
+        ++_children_offsets[operand + 1];
+    }
+    for (size_t gate = 0; gate != gates_count; ++gate) {
+        _children_offsets[gate + 1] += _children_offsets[gate];
+    }
+
+    _children_edges.resize(_operand_edges.size());
+    for (size_t gate = 0; gate != gates_count; ++gate) {
+        for (EdgeIdx pos = _operand_offsets[gate]; pos != _operand_offsets[gate + 1]; ++pos) {
+            _children_edges[_children_offsets[_operand_edges[pos]]++] = static_cast<GateIdx>(gate);
+        }
+    }
+    for (size_t gate = gates_count; gate != 0; --gate) {
+        _children_offsets[gate] = _children_offsets[gate - 1];
+    }
+    _children_offsets[0] = 0;
 }
@@ -1,7 +1,106 @@
 #include "Circuit.h"
+#include "Simulation.h"
+#include <cstdint>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
 
-std::string CircuitSAT::show_result() const {
-    if (get_gate(_output_index).get_value() == ValueEnum::True)
+namespace {
+
+std::string result_name(ValueEnum value) {
+    if (value == ValueEnum::True)
         return "SAT";
+    if (value == ValueEnum::NotDetermined)
+        return "UNKNOWN";
     return "UNSAT";
 }
+
+} // namespace
+
+std::string CircuitSAT::show_result() const {
+    if (_outputs_mode != OutputsEnum::EACH) {
+        return result_name(get_gate(_output_index).get_value());
+    }
+    std::string res;
+    for (size_t pos = 0; pos != _output_indexes.size(); ++pos) {
+        ValueEnum value = pos < _output_results.size() ? _output_results[pos] : ValueEnum::NotDetermined;
+        res += (pos == 0 ? "" : " ") + std::string(get_gate(_output_indexes[pos]).get_name()) + "=" + result_name(value);
+    }
+    return res;
+}
+
+std::string CircuitSAT::show_count() const {
+    std::string res;
+    for (size_t pos = 0; pos != _output_counts.size(); ++pos) {
+        std::string count = _output_results[pos] == ValueEnum::NotDetermined ? "UNKNOWN" : _output_counts[pos].to_string();
+        if (_outputs_mode == OutputsEnum::EACH) {
+            count = std::string(get_gate(_output_indexes[pos]).get_name()) + "=" + count;
+        }
+        res += (pos == 0 ? "" : " ") + count;
+    }
+    return res;
+}
+
+std::vector<bool> CircuitSAT::get_witness() const {
+    /** the input gates left after simplify keep their names from the file **/
+    std::unordered_map<std::string_view, bool> values;
+    for (GateIdx input : _input_gate_indexes) {
+        values.emplace(get_gate(input).get_name(), get_gate(input).get_value() == ValueEnum::True);
+    }
+
+    std::vector<bool> witness(_original_inputs.size(), false);
+    for (size_t pos = 0; pos != _original_inputs.size(); ++pos) {
+        auto it = values.find(_original_inputs.get(pos));
+        witness[pos] = it != values.end() && it->second;
+    }
+    return witness;
+}
+
+bool CircuitSAT::write_witness(std::string const& path, bool binary) const {
+    /** the whole witness is formatted in one buffer and written by one call **/
+    std::vector<bool> witness = get_witness();
+    std::string buffer;
+    if (binary) {
+        auto count = static_cast<uint32_t>(witness.size());
+        buffer = "CSW1";
+        for (int byte = 0; byte != 4; ++byte) {
+            buffer.push_back(static_cast<char>((count >> (8 * byte)) & 0xFF));
+        }
+        buffer.resize(buffer.size() + (witness.size() + 7) / 8, 0);
+        char* bits = buffer.data() + 8;
+        for (size_t pos = 0; pos != witness.size(); ++pos) {
+            if (witness[pos]) {
+                bits[pos / 8] = static_cast<char>(bits[pos / 8] | (1 << (pos % 8)));
+            }
+        }
+    } else {
+        for (size_t pos = 0; pos != witness.size(); ++pos) {
+            buffer += _original_inputs.get(pos);
+            buffer += witness[pos] ? " 1\n" : " 0\n";
+        }
+    }
+
+    std::ofstream out(path, binary ? std::ios::binary | std::ios::trunc : std::ios::trunc);
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+}
+
+bool CircuitSAT::check_witness(std::string const& bench_path, std::vector<bool> const& witness, OutputsEnum mode) {
+    /**
+     * the circuit is parsed again without simplification, so the check covers simplify and the engine.
+     * Every lane of the simulation word gets the same assignment
+     **/
+    CircuitSAT original;
+    original.set_outputs_mode(mode);
+    original.parse(bench_path);
+    if (original.get_input_gate_indexes().size() != witness.size()) {
+        return false;
+    }
+    original.levelize();
+
+    std::vector<Word> input_words(witness.size());
+    for (size_t pos = 0; pos != witness.size(); ++pos) {
+        input_words[pos] = witness[pos] ? ~Word(0) : 0;
+    }
+    return Simulation(original).simulate(input_words) != 0;
+}
@@ -1,116 +1,525 @@
 #include "Circuit.h"
-#include <map>
+#include "Aig.h"
+#include "Fraig.h"
+#include <algorithm>
+#include <cassert>
+#include <string>
 
 void CircuitSAT::simplify() {
-    /** remove gates that do not affect the output or are a copy of another **/
-    _backpropagation_to_use(_output_index);
-    _replace_copy_gates();
-    _remove_unused_gates();
-    _rename_gates();
+    /** remove gates that do not affect the output, then rewrite the rest as a structurally hashed AIG **/
+    {
+        PhaseTimer timer(_stats, PhaseEnum::BACKPROPAGATION);
+        for (GateIdx output : _output_indexes) {
+            _backpropagation_to_use(output);
+        }
+    }
+    {
+        PhaseTimer timer(_stats, PhaseEnum::REMOVE_UNUSED);
+        _remove_unused_gates();
+    }
+    {
+        PhaseTimer timer(_stats, PhaseEnum::RENAME);
+        _rename_gates();
+    }
+    if (_outputs_mode == OutputsEnum::EACH) { // the incremental solver of solve sweeps the cones itself
+        return;
+    }
+    {
+        PhaseTimer timer(_stats, PhaseEnum::REWRITE);
+        _rewrite_aig();
+    }
+    PhaseTimer timer(_stats, PhaseEnum::LEVELIZE);
+    levelize();
 }
 
 void CircuitSAT::_backpropagation_to_use(GateIdx idx) {
-    /** recursive backpropagation of gate influence on the result **/
+    /** mark the gates that the gate depends on, explicit stack so deep circuits don't overflow the call stack **/
+    std::vector<GateIdx> stack{idx};
+    while (!stack.empty()) {
+        GateIdx gate = stack.back();
+        stack.pop_back();
+        if (get_gate(gate).get_used_by_output_value() == ValueEnum::True) { // gate already viewed
+            continue;
+        }
+        set_gate_using(gate, ValueEnum::True);
+        for (GateIdx operand : get_gate(gate).get_operand_indexes()) {
+            if (get_gate(operand).get_used_by_output_value() != ValueEnum::True) {
+                stack.push_back(operand);
+            }
+        }
+    }
+}
+
+void CircuitSAT::levelize() {
+    /**
+     * topological order of the output cone by an explicit-stack DFS over operands, then the gates are sorted
+     * by level with a counting sort, so every gate comes after all its operands and evaluation is a linear sweep
+     **/
+    uint32_t const unvisited = UINT32_MAX;
+    _gate_levels.assign(get_gates_count(), unvisited);
+    std::vector<bool> in_cone(get_gates_count(), false);
+    std::vector<GateIdx> post_order;
+
+    std::vector<std::pair<GateIdx, size_t>> stack; // [gate, next operand to visit]
+    stack.emplace_back(_output_index, 0);
+    in_cone[_output_index] = true;
+    while (!stack.empty()) {
+        auto& [gate, next] = stack.back();
+        GateRange operands = get_gate(gate).get_operand_indexes();
+        if (next != operands.size()) {
+            GateIdx operand = operands[next++];
+            if (!in_cone[operand]) {
+                in_cone[operand] = true;
+                stack.emplace_back(operand, 0);
+            } else {
+                assert(_gate_levels[operand] != unvisited && "Circuit has a cycle");
+            }
+            continue;
+        }
+
+        assert(get_gate(gate).get_operator_type() != OperatorsEnum::UNKNOWN && "Gate has no operator");
+        uint32_t level = 0;
+        for (GateIdx operand : operands) {
+            level = std::max(level, _gate_levels[operand] + 1);
+        }
+        _gate_levels[gate] = level;
+        post_order.push_back(gate);
+        stack.pop_back();
+    }
+
+    uint32_t levels_count = _gate_levels[_output_index] + 1;
+    _level_offsets.assign(levels_count + 1, 0);
+    for (GateIdx gate : post_order) {
+        ++_level_offsets[_gate_levels[gate] + 1];
+    }
+    for (size_t level = 0; level != levels_count; ++level) {
+        _level_offsets[level + 1] += _level_offsets[level];
+    }
+    _level_order.resize(post_order.size());
+    std::vector<EdgeIdx> fill(_level_offsets.begin(), _level_offsets.end() - 1);
+    for (GateIdx gate : post_order) {
+        _level_order[fill[_gate_levels[gate]]++] = gate;
+    }
+}
 
-    if (get_gate(idx).get_used_by_output_value() != ValueEnum::True) { // gate not viewed yet?
-        set_gate_using(idx, ValueEnum::True);
+void CircuitSAT::_remove_unused_gates() {
+    /**
+     * compact the gate arrays in place to the gates used by the output, _new_indexes keeps the dense renaming.
+     * A kept gate and its operands never move to a higher position, so the arrays are compacted front to back
+     * without a second copy of the circuit
+     **/
+    GateIdx const unused = UINT32_MAX;
+    size_t gates_count = get_gates_count();
+    _new_indexes.assign(gates_count, unused);
 
-        for (GateIdx operand : get_gate(idx).get_operand_indexes()) {
-            _backpropagation_to_use(operand);
+    GateIdx kept = 0;
+    EdgeIdx edges_end = 0;
+    EdgeIdx begin = 0;
+    for (size_t idx = 0; idx != gates_count; ++idx) {
+        EdgeIdx end = _operand_offsets[idx + 1];
+        if (_used_by_output[idx] == ValueEnum::True) {
+            _new_indexes[idx] = kept;
+            _operators[kept] = _operators[idx];
+            _values[kept] = _values[idx];
+            for (EdgeIdx pos = begin; pos != end; ++pos) {
+                _operand_edges[edges_end++] = _operand_edges[pos];
+            }
+            _operand_offsets[++kept] = edges_end;
         }
-        
+        begin = end;
     }
+    _names.compact(_new_indexes);
+
+    _operators.resize(kept);
+    _values.resize(kept);
+    _operand_offsets.resize(kept + 1);
+    _operand_edges.resize(edges_end);
+    _used_by_output.assign(kept, ValueEnum::True);
 }
 
-std::string encode_gate_name(size_t pos_gate, CircuitSAT& obj) {
-    std::string name = std::to_string(static_cast<int>(obj.get_gate(pos_gate).get_operator_type()));
-    for (GateIdx operand : obj.get_gate(pos_gate).get_operand_indexes()) {
-        name += "_" + std::to_string(operand);
+void CircuitSAT::_rename_gates() {
+    /** rename gates that remain after circuit transformations **/
+
+    // change operand indices and assemble a new vector of input gates
+    for (GateIdx& operand : _operand_edges) {
+        operand = _new_indexes[operand];
+    }
+    clear_input_gate_indexes();
+    for (size_t pos_gate = 0; pos_gate != get_gates_count(); ++pos_gate) {
+        if (get_gate(pos_gate).get_operator_type() == OperatorsEnum::INPUT) {
+            append_input_gate(static_cast<GateIdx>(pos_gate));
+        }
     }
 
-    return name;
+    // change outputs
+    set_idx_output(_new_indexes[_output_index]);
+    for (GateIdx& output : _output_indexes) {
+        output = _new_indexes[output];
+    }
+    _new_indexes.clear();
+    _build_children();
+}
+
+AigLit CircuitSAT::gate_to_aig(Aig& aig, OperatorsEnum op, std::vector<AigLit> const& operand_lits) {
+    /** literal of the gate function over the literals of its operands, NAND/NOR/NXOR/NOT negate the result **/
+    AigLit lit = aig_undef;
+    switch (op) {
+        case OperatorsEnum::AND:
+        case OperatorsEnum::NAND:
+            lit = aig_true;
+            for (AigLit operand : operand_lits) {
+                lit = aig.make_and(lit, operand);
+            }
+            break;
+        case OperatorsEnum::OR:
+        case OperatorsEnum::NOR:
+            lit = aig_false;
+            for (AigLit operand : operand_lits) {
+                lit = aig.make_or(lit, operand);
+            }
+            break;
+        case OperatorsEnum::XOR:
+        case OperatorsEnum::NXOR:
+            lit = aig_false;
+            for (AigLit operand : operand_lits) {
+                lit = aig.make_xor(lit, operand);
+            }
+            break;
+        case OperatorsEnum::NOT:
+        case OperatorsEnum::BUFF:
+            lit = operand_lits.at(0);
+            break;
+        default:
+            assert(false && "Gate has no operator");
+    }
+    if (op == OperatorsEnum::NAND || op == OperatorsEnum::NOR || op == OperatorsEnum::NXOR
+            || op == OperatorsEnum::NOT) {
+        lit = aig_neg(lit);
+    }
+    return lit;
 }
 
-void change_gate_index(size_t old_index, size_t new_index, CircuitSAT& obj) {
+void CircuitSAT::cone_to_aig(Aig& aig, std::vector<AigLit>& gate_lits, GateIdx root) const {
     /**
-     * changes the operands of those gates that used the old gate
+     * literals of the gates of the cone of root, gates that already have a literal are kept,
+     * so the same graph can be extended cone by cone. Input gates without a literal become new AIG inputs
      **/
-    for (size_t child : obj.get_gate(old_index).get_children_indexes()) {
-        VecGates operands = obj.get_gate(child).get_operand_indexes();
-        for (size_t pos_operand = 0; pos_operand != operands.size(); ++pos_operand) {
-            if (operands[pos_operand] == obj.get_gate(old_index).get_gate_index()) {
-                obj.change_gate_operand(child, pos_operand, new_index);
+    if (gate_lits.size() < get_gates_count()) {
+        gate_lits.resize(get_gates_count(), aig_undef);
+    }
+
+    // gates in topological order by an explicit stack, 1 -- operands are being converted
+    std::vector<uint8_t> state(get_gates_count(), 0);
+    std::vector<GateIdx> stack{root};
+    std::vector<AigLit> operand_lits;
+    while (!stack.empty()) {
+        GateIdx gate = stack.back();
+        if (gate_lits[gate] != aig_undef) {
+            stack.pop_back();
+            continue;
+        }
+        if (get_gate(gate).get_operator_type() == OperatorsEnum::INPUT) {
+            gate_lits[gate] = aig.create_input();
+            stack.pop_back();
+            continue;
+        }
+        if (state[gate] == 0) {
+            state[gate] = 1;
+            for (GateIdx operand : get_gate(gate).get_operand_indexes()) {
+                if (gate_lits[operand] == aig_undef) {
+                    assert(state[operand] == 0 && "Circuit has a cycle");
+                    stack.push_back(operand);
+                }
             }
+            continue;
         }
+        stack.pop_back();
+
+        operand_lits.clear();
+        for (GateIdx operand : get_gate(gate).get_operand_indexes()) {
+            operand_lits.push_back(gate_lits[operand]);
+        }
+        gate_lits[gate] = gate_to_aig(aig, get_gate(gate).get_operator_type(), operand_lits);
     }
 }
 
-void CircuitSAT::_replace_copy_gates() {
+void CircuitSAT::_rewrite_aig() {
     /**
-     * finds gates with the same operands and operator,
-     * takes the first one as a basis,
-     * changes the operands of all gates where the second gate was used
-     * and marks the second gate as unnecessary
+     * converts the circuit to an And-Inverter Graph, gates with the same function of the same operands
+     * (up to the order of operands and De Morgan forms) become one node, constants are propagated and
+     * local two-level rules are applied. The graph is rebuilt until the number of AND nodes stops decreasing,
+     * functionally equivalent nodes are merged by SAT sweeping within a conflict and time budget (not for large
+     * graphs or if sweeping is switched off), then the graph is converted back to gates.
+     * The rewritten circuit is kept only if it has fewer gates
      **/
-    std::map<std::string, GateIdx> map_gate_name_to_idx;
-    std::string encoded_name;
+    _removed_by_rewriting = 0;
+    _merged_by_sweeping = 0;
 
-    for (size_t gate_index = 0; gate_index != get_gates().size(); ++gate_index) {
-        if (get_gate(gate_index).get_operator_type() != OperatorsEnum::INPUT
-                && get_gate(gate_index).get_used_by_output_value() == ValueEnum::True) {
-
-            encoded_name = encode_gate_name(get_gate(gate_index).get_gate_index(), *this);
+    Aig aig;
+    std::vector<AigLit> gate_lits(get_gates_count(), aig_undef);
+    for (GateIdx input : _input_gate_indexes) {
+        gate_lits[input] = aig.create_input();
+    }
 
-            if (map_gate_name_to_idx.find(encoded_name) == map_gate_name_to_idx.end()) {
-                map_gate_name_to_idx[encoded_name] = get_gate(gate_index).get_gate_index();
+    cone_to_aig(aig, gate_lits, _output_index);
 
-            } else {
-                change_gate_index(gate_index, map_gate_name_to_idx.at(encoded_name), *this);
-                set_gate_using(gate_index, ValueEnum::False);
+    // fixpoint: every rebuild drops dangling nodes and rewrites the nodes with simplified operands again
+    AigLit root = gate_lits[_output_index];
+    auto compact_to_fixpoint = [&aig, &root, &gate_lits]() {
+        while (true) {
+            size_t ands_count = aig.get_ands_count();
+            aig = aig.compact(root, gate_lits);
+            if (aig.get_ands_count() >= ands_count) {
+                break;
             }
         }
+    };
+    compact_to_fixpoint();
+
+    // SAT sweeping merges functionally equivalent nodes that differ structurally
+    if (_sweeping && aig.get_ands_count() <= max_swept_ands) {
+        {
+            PhaseTimer timer(_stats, PhaseEnum::SWEEPING);
+            Fraig fraig(aig);
+            fraig.set_stop(_stop);
+            fraig.set_budget(sweeping_conflicts, sweeping_seconds);
+            aig = fraig.run(root, gate_lits);
+            _merged_by_sweeping = fraig.get_merged();
+        }
+        compact_to_fixpoint();
+    }
+
+    size_t gates_count = get_gates_count();
+    if (_rebuild_from_aig(aig, root, gate_lits) && get_gates_count() < gates_count) {
+        _removed_by_rewriting = gates_count - get_gates_count();
     }
 }
 
-void CircuitSAT::_remove_unused_gates() {
-    std::vector<Gate> new_gates;
-    for (size_t idx = 0; idx != get_gates().size(); ++idx) {
-        if (get_gate(idx).get_used_by_output_value() == ValueEnum::True) {
-            new_gates.push_back(get_gate(idx));
+bool CircuitSAT::_rebuild_from_aig(Aig const& aig, AigLit root, std::vector<AigLit> const& gate_lits) {
+    /**
+     * converts the AIG back to gates if it gives fewer gates than the current circuit:
+     *  - the XOR pattern !(a & b) & !(!a & !b) becomes XOR/NXOR;
+     *  - trees of single-use AND nodes become one AND/NAND, AND of complemented operands becomes NOR/OR;
+     *  - a NOT gate is added only if a node is needed in both polarities.
+     * Gates keep the name of the first original gate with the same function. The size of the new circuit is
+     * counted first: the arrays are allocated once, and the old edges are released before they are
+     **/
+    size_t nodes_count = aig.get_nodes_count();
+    GateIdx const none = UINT32_MAX;
+
+    std::vector<uint32_t> refs(nodes_count, 0);
+    ++refs[aig_node(root)];
+    for (uint32_t node = 1; node != nodes_count; ++node) {
+        if (aig.is_and(node)) {
+            ++refs[aig_node(aig.get_fanin0(node))];
+            ++refs[aig_node(aig.get_fanin1(node))];
         }
     }
-    _gates = new_gates;
-}
 
-void CircuitSAT::_rename_gates() {
-    /** rename gates that remain after circuit transformations **/
+    std::vector<bool> is_xor(nodes_count, false);
+    for (uint32_t node = 1; node != nodes_count; ++node) {
+        AigLit lhs = aig.is_and(node) ? aig.get_fanin0(node) : aig_undef;
+        AigLit rhs = aig.is_and(node) ? aig.get_fanin1(node) : aig_undef;
+        if (lhs == aig_undef || !aig_is_complemented(lhs) || !aig_is_complemented(rhs)
+                || !aig.is_and_lit(lhs) || !aig.is_and_lit(rhs)
+                || refs[aig_node(lhs)] != 1 || refs[aig_node(rhs)] != 1) {
+            continue;
+        }
+        AigLit p0 = aig.get_fanin0(aig_node(lhs)), p1 = aig.get_fanin1(aig_node(lhs));
+        AigLit q0 = aig.get_fanin0(aig_node(rhs)), q1 = aig.get_fanin1(aig_node(rhs));
+        is_xor[node] = (q0 == aig_neg(p0) && q1 == aig_neg(p1)) || (q0 == aig_neg(p1) && q1 == aig_neg(p0));
+    }
+
+    // operands of the gate of every needed node, from the output down; demand: 1 -- positive, 2 -- negative
+    std::vector<uint8_t> demand(nodes_count, 0);
+    std::vector<size_t> leaf_begin(nodes_count, 0);
+    std::vector<size_t> leaf_end(nodes_count, 0);
+    std::vector<AigLit> leaves;
+    std::vector<bool> inverted_form(nodes_count, false);    // XOR with odd parity or AND of complemented leaves
+    std::vector<AigLit> stack;
+    demand[aig_node(root)] |= aig_is_complemented(root) ? 2 : 1;
+
+    for (uint32_t node = static_cast<uint32_t>(nodes_count); node-- > 1;) {
+        if (demand[node] == 0 || !aig.is_and(node)) {
+            continue;
+        }
+        leaf_begin[node] = leaves.size();
+
+        if (is_xor[node]) { // XOR and NXOR gates take two operands
+            AigLit lhs = aig.get_fanin0(aig_node(aig.get_fanin0(node)));
+            AigLit rhs = aig.get_fanin1(aig_node(aig.get_fanin0(node)));
+            leaves.push_back(aig_regular(lhs));
+            leaves.push_back(aig_regular(rhs));
+            inverted_form[node] = aig_is_complemented(lhs) != aig_is_complemented(rhs);
+        } else {
+            stack = {aig.get_fanin0(node), aig.get_fanin1(node)};
+            while (!stack.empty()) {
+                AigLit lit = stack.back();
+                stack.pop_back();
+                uint32_t leaf = aig_node(lit);
+                if (!aig_is_complemented(lit) && aig.is_and(leaf) && !is_xor[leaf] && refs[leaf] == 1) {
+                    stack.push_back(aig.get_fanin0(leaf));
+                    stack.push_back(aig.get_fanin1(leaf));
+                } else {
+                    leaves.push_back(lit);
+                }
+            }
+            std::sort(leaves.begin() + static_cast<std::ptrdiff_t>(leaf_begin[node]), leaves.end());
+            leaves.erase(std::unique(leaves.begin() + static_cast<std::ptrdiff_t>(leaf_begin[node]), leaves.end()),
+                         leaves.end());
+            inverted_form[node] = std::all_of(leaves.begin() + static_cast<std::ptrdiff_t>(leaf_begin[node]),
+                                              leaves.end(), aig_is_complemented);
+        }
+        leaf_end[node] = leaves.size();
+
+        for (size_t pos = leaf_begin[node]; pos != leaf_end[node]; ++pos) {
+            bool negative = aig_is_complemented(leaves[pos]) && !is_xor[node] && !inverted_form[node];
+            demand[aig_node(leaves[pos])] |= negative ? 2 : 1;
+        }
+    }
 
-    // fill in the dictionary and change the indexes in the struct Gate
-    std::map<GateIdx, GateIdx> map_old_to_new_idx;
-    GateIdx new_index = 0;
-    for (size_t pos_index = 0; pos_index != get_gates().size(); ++pos_index) {
-        map_old_to_new_idx[get_gate(pos_index).get_gate_index()] = new_index;
-        set_gate_index(pos_index, new_index);
-        ++new_index;
+    // size of the rebuilt circuit, known before it is built: NOT gates for the nodes needed in both polarities
+    auto needs_not = [&aig, &demand](uint32_t node) {
+        return (demand[node] & 3) == 3 || (!aig.is_and(node) && (demand[node] & 2));
+    };
+    size_t new_gates_count = 3; // a constant output is x & !x or x | !x
+    size_t new_edges_count = 3;
+    if (aig_node(root) != 0) {
+        new_gates_count = 0;
+        new_edges_count = 0;
+        for (GateIdx input : _input_gate_indexes) {
+            new_gates_count += gate_lits[input] != aig_undef && demand[aig_node(gate_lits[input])] != 0;
+        }
+        for (uint32_t node = 1; node != nodes_count; ++node) {
+            if (demand[node] != 0 && aig.is_and(node)) {
+                ++new_gates_count;
+                new_edges_count += leaf_end[node] - leaf_begin[node];
+            }
+            if (demand[node] != 0 && needs_not(node)) {
+                ++new_gates_count;
+                ++new_edges_count;
+            }
+        }
+    } else if (_input_gate_indexes.empty()) {
+        return false;
+    }
+    // every "not rebuilt" return is above: the circuit must stay intact when it isn't replaced
+    if (new_gates_count >= get_gates_count()) {
+        return false;
+    }
+    // from here the old gates are needed only for their names, their edges are released before the new ones grow
+    for (VecGates* edges : {&_operand_edges, &_children_edges, &_level_order}) {
+        edges->clear();
+        edges->shrink_to_fit();
     }
 
-    // change operand indices in the class CircuitSAT and assemble a new vector of input gates
-    clear_input_gate_indexes();
-    for (size_t pos_gate = 0; pos_gate != get_gates().size(); ++pos_gate) {
-        for (size_t num_operand = 0; num_operand != get_gate(pos_gate).get_operand_indexes().size(); ++num_operand) {
-            change_gate_operand(
-                    pos_gate,
-                    num_operand,
-                    map_old_to_new_idx[get_gate(pos_gate).get_operand_index(num_operand)]
-            );
+    // names of the original gates by their literal, input gates first
+    std::vector<GateIdx> name_gate(2 * nodes_count, none);
+    std::vector<GateIdx> input_gate(nodes_count, none);
+    for (GateIdx input : _input_gate_indexes) {
+        if (gate_lits[input] != aig_undef) {
+            name_gate[gate_lits[input]] = input;
+            input_gate[aig_node(gate_lits[input])] = input;
         }
-        if (get_gate(pos_gate).get_operator_type() == OperatorsEnum::INPUT) {
-            append_input_gate(pos_gate);
+    }
+    for (GateIdx gate = 0; gate != gate_lits.size(); ++gate) {
+        if (gate_lits[gate] != aig_undef && name_gate[gate_lits[gate]] == none) {
+            name_gate[gate_lits[gate]] = gate;
         }
     }
 
-    // change output
-    set_idx_output(map_old_to_new_idx[_output_index]);
+    std::vector<OperatorsEnum> operators;
+    std::vector<EdgeIdx> operand_offsets{0};
+    VecGates operand_edges;
+    NameTable names;
+    VecGates input_gate_indexes;
+    std::vector<GateIdx> gate_of(2 * nodes_count, none);
+    operators.reserve(new_gates_count);
+    operand_offsets.reserve(new_gates_count + 1);
+    operand_edges.reserve(new_edges_count);
 
-}
+    auto emit = [&](OperatorsEnum op, AigLit lit, GateRange operands) {
+        GateIdx gate = static_cast<GateIdx>(operators.size());
+        operators.push_back(op);
+        operand_edges.insert(operand_edges.end(), operands.begin(), operands.end());
+        operand_offsets.push_back(static_cast<EdgeIdx>(operand_edges.size()));
+        if (lit == aig_undef) {
+            names.append("aig$const" + std::to_string(gate));
+            return gate;
+        }
+        if (name_gate[lit] != none) {
+            names.append(get_gate(name_gate[lit]).get_name());
+        } else {
+            names.append("aig$" + std::to_string(aig_node(lit)) + (aig_is_complemented(lit) ? "$not" : ""));
+        }
+        gate_of[lit] = gate;
+        return gate;
+    };
+
+    GateIdx output;
+    if (aig_node(root) == 0) {
+        // constant output: x & !x or x | !x over the first input
+        GateIdx input = static_cast<GateIdx>(operators.size());
+        operators.push_back(OperatorsEnum::INPUT);
+        operand_offsets.push_back(static_cast<EdgeIdx>(operand_edges.size()));
+        names.append(get_gate(_input_gate_indexes[0]).get_name());
+        GateIdx operands[2] = {input, input};
+        operands[1] = emit(OperatorsEnum::NOT, aig_undef, {operands, operands + 1});
+        output = emit(root == aig_true ? OperatorsEnum::OR : OperatorsEnum::AND, aig_undef, {operands, operands + 2});
+        input_gate_indexes.push_back(input);
+    } else {
+        for (GateIdx input : _input_gate_indexes) {
+            if (gate_lits[input] != aig_undef && demand[aig_node(gate_lits[input])] != 0) {
+                input_gate_indexes.push_back(emit(OperatorsEnum::INPUT, gate_lits[input], {nullptr, nullptr}));
+            }
+        }
+
+        std::vector<GateIdx> operands;
+        for (uint32_t node = 1; node != nodes_count; ++node) {
+            if (demand[node] == 0) {
+                continue;
+            }
+            AigLit positive = aig_make_lit(node);
+            if (aig.is_and(node)) {
+                OperatorsEnum op_positive = OperatorsEnum::AND;
+                OperatorsEnum op_negative = OperatorsEnum::NAND;
+                if (is_xor[node]) {
+                    op_positive = inverted_form[node] ? OperatorsEnum::NXOR : OperatorsEnum::XOR;
+                    op_negative = inverted_form[node] ? OperatorsEnum::XOR : OperatorsEnum::NXOR;
+                } else if (inverted_form[node]) {
+                    op_positive = OperatorsEnum::NOR;
+                    op_negative = OperatorsEnum::OR;
+                }
 
+                operands.clear();
+                for (size_t pos = leaf_begin[node]; pos != leaf_end[node]; ++pos) {
+                    AigLit leaf = (is_xor[node] || inverted_form[node]) ? aig_regular(leaves[pos]) : leaves[pos];
+                    operands.push_back(gate_of[leaf]);
+                }
+                GateRange range(operands.data(), operands.data() + operands.size());
+                if (demand[node] & 1) {
+                    emit(op_positive, positive, range);
+                } else {
+                    emit(op_negative, aig_neg(positive), range);
+                }
+            }
+            if (needs_not(node)) {
+                emit(OperatorsEnum::NOT, aig_neg(positive), {&gate_of[positive], &gate_of[positive] + 1});
+            }
+        }
+        output = gate_of[root];
+    }
+
+    assert(operators.size() == new_gates_count && operand_edges.size() == new_edges_count && "Wrong size of the circuit");
+    _operators = std::move(operators);
+    _operand_offsets = std::move(operand_offsets);
+    _operand_edges = std::move(operand_edges);
+    _names = std::move(names);
+    _values.assign(_operators.size(), ValueEnum::NotDetermined);
+    _used_by_output.assign(_operators.size(), ValueEnum::True);
+    _input_gate_indexes = std::move(input_gate_indexes);
+    _output_index = output;
+    _output_indexes.assign(1, output);
+    _build_children();
+    return true;
+}
@@ -1,72 +1,497 @@
 #include "Circuit.h"
 #include "Operators.h"
-#include <map>
-
-using operator_ = bool(*)(VecGates const&, CircuitSAT&);
-using func_map = std::map<OperatorsEnum, operator_>;
-
-inline operator_ getOperatorMap(OperatorsEnum _operator) {
-    static func_map oper_to_func { /** connection of operators and their functions **/
-            {OperatorsEnum::AND, &Operators::gate_AND},
-            {OperatorsEnum::OR, &Operators::gate_OR},
-            {OperatorsEnum::NOT, Operators::gate_NOT},
-            {OperatorsEnum::XOR, &Operators::gate_XOR},
-            {OperatorsEnum::NAND, &Operators::gate_NAND},
-            {OperatorsEnum::NOR, Operators::gate_NOR},
-            {OperatorsEnum::NXOR, &Operators::gate_NXOR},
-            {OperatorsEnum::BUFF, &Operators::gate_BUFF}
+#include "Simulation.h"
+#include "Tseitin.h"
+#include "Justification.h"
+#include "CubeAndConquer.h"
+#include "Incremental.h"
+#include "Counting.h"
+#include "Decomposition.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint64_t stats_assignments = 4096; // assignments of the enumeration between the additions to Stats
+constexpr uint64_t dense_fraction = 8;        // the enumeration sweeps the whole cone if a flip changes 1/8 of it
+constexpr auto stop_check_period = std::chrono::milliseconds(10); // the parts see the outer stop flag this late
+
+} // namespace
+
+bool CircuitSAT::solve() {
+    PhaseTimer timer(_stats, PhaseEnum::SOLVE);
+    return _solve() == ValueEnum::True;
+}
+
+ValueEnum CircuitSAT::_solve() {
+    /**
+     * result of the objective, it is also kept as the value of the output gate.
+     * The parts of _solve_parts call it directly, so their time isn't added to the solve phase twice
+     **/
+    if (_outputs_mode == OutputsEnum::EACH) {
+        ValueEnum result = _solve_each_output();
+        set_gate_value(_output_index, _output_results.front());
+        return result;
+    }
+    if (_level_order.empty()) { // simplify computes the order, a circuit that wasn't simplified gets it here
+        levelize();
+    }
+    ValueEnum result;
+    if (_solve_parts(result)) {
+        // the parts were solved by the selected engine
+    } else if (_engine == EngineEnum::SIMULATION) {
+        result = _solve_simulation();
+    } else if (_engine == EngineEnum::CDCL) {
+        result = _solve_cdcl();
+    } else if (_engine == EngineEnum::CIRCUIT) {
+        result = _solve_circuit();
+    } else if (_engine == EngineEnum::CUBE) {
+        result = _solve_cube();
+    } else {
+        result = _solve_enumeration();
+    }
+    set_gate_value(_output_index, result);
+    return result;
+}
+
+bool CircuitSAT::_evaluate() {
+    /**
+     * values of the gates for the current values of the input gates, a linear sweep over the level order.
+     * Level 0 holds the input gates, the sweep starts after it and reads the raw arrays directly
+     **/
+    ValueEnum* values = _values.data();
+    GateIdx const* edges = _operand_edges.data();
+    EdgeIdx const* offsets = _operand_offsets.data();
+    OperatorsEnum const* operators = _operators.data();
+    for (auto it = _level_order.begin() + _level_offsets[1]; it != _level_order.end(); ++it) {
+        GateIdx gate = *it;
+        EdgeIdx begin = offsets[gate];
+        bool res = Operators::evaluate(operators[gate], edges + begin, offsets[gate + 1] - begin, values);
+        values[gate] = res ? ValueEnum::True : ValueEnum::False;
+    }
+    return values[_output_index] == ValueEnum::True;
+}
+
+ValueEnum CircuitSAT::_solve_enumeration() {
+    /**
+     * enumeration of possible input gate values in Gray-code order: consecutive assignments differ in one input,
+     * so after the first full pass only the fan-out of the flipped input is re-evaluated. Pending gates are bits
+     * of a bitmap over the positions in the level order: children come later in the order than their operands,
+     * so one scan of the bitmap from the lowest position is a levelized event queue. A gate whose value doesn't
+     * change doesn't schedule its children, an assignment costs the gates that actually changed. If the first
+     * assignments change a large part of the cone on average, the queue costs more than it saves and every
+     * assignment is evaluated by the linear sweep. On success the input gates keep the satisfying assignment
+     **/
+    VecGates const& inputs = get_input_gate_indexes();
+    ValueEnum* values = _values.data();
+    for (GateIdx input : inputs) {
+        values[input] = ValueEnum::True;
+    }
+
+    // children in the output cone of every gate, as positions in the level order
+    GateIdx const outside = UINT32_MAX;
+    std::vector<GateIdx> position(get_gates_count(), outside);
+    for (size_t pos = 0; pos != _level_order.size(); ++pos) {
+        position[_level_order[pos]] = static_cast<GateIdx>(pos);
+    }
+    std::vector<EdgeIdx> fanout_offsets{0};
+    VecGates fanout;
+    for (GateIdx gate : _level_order) {
+        for (GateIdx child : get_gate(gate).get_children_indexes()) {
+            if (position[child] != outside) {
+                fanout.push_back(position[child]);
+            }
+        }
+        fanout_offsets.push_back(static_cast<EdgeIdx>(fanout.size()));
+    }
+
+    GateIdx const* edges = _operand_edges.data();
+    EdgeIdx const* offsets = _operand_offsets.data();
+    OperatorsEnum const* operators = _operators.data();
+    GateIdx const* order = _level_order.data();
+    std::vector<uint64_t> pending((_level_order.size() + 63) / 64, 0);
+    size_t last_word = 0; // highest word of pending with a bit set
+    auto schedule_children = [&](size_t pos) {
+        for (EdgeIdx edge = fanout_offsets[pos]; edge != fanout_offsets[pos + 1]; ++edge) {
+            pending[fanout[edge] >> 6] |= uint64_t(1) << (fanout[edge] & 63);
+            last_word = std::max<size_t>(last_word, fanout[edge] >> 6);
+        }
+    };
+
+    uint64_t cone_gates = _level_order.size() - _level_offsets[1];
+    uint64_t evaluated = 0; // assignments not added to _stats yet
+    uint64_t gate_evaluations = cone_gates;
+    auto add_stats = [this, &evaluated, &gate_evaluations] {
+        if (_stats != nullptr) {
+            _stats->add_evaluations(evaluated, gate_evaluations);
+        }
+        evaluated = 0;
+        gate_evaluations = 0;
     };
 
-    return oper_to_func.at(_operator);
+    /**
+     * the binary counter over the inputs gives the Gray code: the next assignment flips the input of its lowest
+     * zero bit. As in the former lexicographic order, the enumeration starts with True and the last input changes
+     * most often, so after 2^k assignments the first n - k inputs still have their initial values
+     **/
+    std::vector<bool> counter(inputs.size(), false);
+    bool satisfied = _evaluate();
+    bool full_sweep = false;
+    ValueEnum result = ValueEnum::True;
+    while (!satisfied) {
+        if (++evaluated == stats_assignments) {
+            full_sweep = full_sweep || gate_evaluations * dense_fraction > evaluated * cone_gates;
+            add_stats();
+        }
+        if (_is_stopped()) {
+            result = ValueEnum::NotDetermined;
+            break;
+        }
+        size_t bit = 0;
+        for (; bit != counter.size() && counter[bit]; ++bit) {
+            counter[bit] = false;
+        }
+        if (bit == counter.size()) {
+            result = ValueEnum::False;
+            break;
+        }
+        counter[bit] = true;
+
+        GateIdx input = inputs[inputs.size() - 1 - bit];
+        values[input] = values[input] == ValueEnum::True ? ValueEnum::False : ValueEnum::True;
+        if (full_sweep) {
+            satisfied = _evaluate();
+            gate_evaluations += cone_gates;
+            continue;
+        }
+        if (position[input] == outside) {
+            continue; // the input doesn't reach the output
+        }
+        last_word = 0;
+        schedule_children(position[input]);
+        for (size_t word = position[input] >> 6; word <= last_word; ++word) {
+            while (pending[word] != 0) { // children of a gate of this word may be added to it
+                size_t pos = (word << 6) + static_cast<size_t>(__builtin_ctzll(pending[word]));
+                pending[word] &= pending[word] - 1;
+                GateIdx gate = order[pos];
+                EdgeIdx begin = offsets[gate];
+                ValueEnum value = Operators::evaluate(operators[gate], edges + begin, offsets[gate + 1] - begin, values)
+                                  ? ValueEnum::True : ValueEnum::False;
+                ++gate_evaluations;
+                if (value != values[gate]) {
+                    values[gate] = value;
+                    schedule_children(pos);
+                }
+            }
+        }
+        satisfied = values[_output_index] == ValueEnum::True;
+    }
+    evaluated += result == ValueEnum::True; // the satisfying assignment
+    add_stats();
+    return result;
 }
 
-bool CircuitSAT::solve() {
-    return _solve(0, ValueEnum::True) || _solve(0, ValueEnum::False);
+ValueEnum CircuitSAT::_solve_simulation() {
+    /** bit-parallel enumeration (parallel over prefix cubes), on success the input gates keep the satisfying assignment **/
+    Simulation simulation(*this);
+    std::vector<ValueEnum> assignment;
+    ValueEnum result = simulation.search(assignment, _threads_count, _stop, _stats);
+
+    if (result == ValueEnum::True) {
+        for (size_t pos = 0; pos != get_input_gate_indexes().size(); ++pos) {
+            set_gate_value(get_input_gate_index(pos), assignment[pos]);
+        }
+    }
+    return result;
 }
 
-void reset_value(CircuitSAT& obj) { // reset the old values
-    for (size_t idx_gate = 0; idx_gate != obj.get_gates().size(); ++idx_gate) {
-        if (obj.get_gate(idx_gate).get_operator_type() == OperatorsEnum::INPUT) {
-            obj.set_gate_status_calculate(idx_gate, ValueEnum::True);
-        } else {
-            obj.set_gate_status_calculate(idx_gate, ValueEnum::NotDetermined);
+ValueEnum CircuitSAT::_solve_cdcl() {
+    /** Tseitin encoding of the output cone + CDCL, on success the input gates keep the model **/
+    CdclSolver solver;
+    TseitinEncoding encoding(solver);
+    solver.add_clause({encoding.encode(*this, _output_index)});
+    solver.set_stop(_stop);
+    solver.set_stats(_stats);
+    ValueEnum result = solver.solve();
+
+    if (result == ValueEnum::True) {
+        for (GateIdx input : get_input_gate_indexes()) {
+            set_gate_value(input, encoding.is_encoded(input)
+                                  ? solver.model_value(lit_var(encoding.get_literal(input)))
+                                  : ValueEnum::False);
         }
     }
+    return result;
 }
 
-void calculate_gate(size_t pos_gate, CircuitSAT& obj) {
-    /** recursive solution of the circuit for given values of input gates **/
+ValueEnum CircuitSAT::_solve_circuit() {
+    /** clause learning on the gate graph, on success the input gates keep the model **/
+    JustificationSolver solver(*this);
+    solver.set_stop(_stop);
+    solver.set_stats(_stats);
+    ValueEnum result = solver.solve(_output_index);
 
-    for (size_t idx_operand : obj.get_gate(pos_gate).get_operand_indexes()) { // check gate operands
-        // 0 - needs to be solved, 1 - has already been solved at the previous stages
-        if (obj.get_gate(idx_operand).get_status_calculate() != ValueEnum::True) {
-            calculate_gate(idx_operand, obj);
+    if (result == ValueEnum::True) {
+        for (GateIdx input : get_input_gate_indexes()) {
+            set_gate_value(input, solver.model_value(input));
         }
     }
+    return result;
+}
 
-    // calculate the gate itself
-    obj.set_gate_status_calculate(pos_gate, ValueEnum::True);
-    operator_ op = getOperatorMap(obj.get_gate(pos_gate).get_operator_type());
-    bool res = op(obj.get_gate(pos_gate).get_operand_indexes(), obj);
+ValueEnum CircuitSAT::_solve_cube() {
+    /** cube-and-conquer on _threads_count threads, on success the input gates keep the model **/
+    CubeAndConquer solver(*this);
+    ValueEnum result = solver.solve(_threads_count, _stop);
 
-    if (res) {
-        obj.set_gate_value(pos_gate, ValueEnum::True);
-    } else {
-        obj.set_gate_value(pos_gate, ValueEnum::False);
+    if (result == ValueEnum::True) {
+        for (GateIdx input : get_input_gate_indexes()) {
+            set_gate_value(input, solver.model_value(input));
+        }
     }
+    return result;
+}
 
+ValueEnum CircuitSAT::_solve_each_output() {
+    /**
+     * every output is a query to one incremental solver: the netlist is converted and swept once, the encoding
+     * of the shared logic and the learned clauses are reused. An output proven UNSAT stays false for the later
+     * queries. True if some output is SAT; the input gates keep no model, the outputs have different ones
+     **/
+    IncrementalSolver solver(*this);
+    _output_results.assign(_output_indexes.size(), ValueEnum::NotDetermined);
+    ValueEnum result = ValueEnum::False;
+    for (size_t pos = 0; pos != _output_indexes.size() && !_is_stopped(); ++pos) {
+        GateIdx output = _output_indexes[pos];
+        _output_results[pos] = solver.solve({{output, true}});
+        if (_output_results[pos] == ValueEnum::True) {
+            result = ValueEnum::True;
+        } else if (_output_results[pos] == ValueEnum::False) {
+            solver.add_constraint(output, false);
+        }
+    }
+    if (result != ValueEnum::True
+        && std::find(_output_results.begin(), _output_results.end(), ValueEnum::NotDetermined) != _output_results.end()) {
+        result = ValueEnum::NotDetermined;
+    }
+    return result;
 }
 
-bool CircuitSAT::_solve(size_t pos_input_gate, ValueEnum value) {
-    /** recursive enumeration of possible input gate values + get circuit result **/
-    set_gate_value(get_input_gate_index(pos_input_gate), value);
+bool CircuitSAT::count() {
+    /**
+     * models are counted over the inputs of the output cone, every original input outside the cone
+     * (removed by simplify or never used) doubles the count. In the EACH mode every output gets its own order
+     **/
+    PhaseTimer timer(_stats, PhaseEnum::COUNT);
+    GateIdx objective = _output_index;
+    _output_results.assign(_output_indexes.size(), ValueEnum::NotDetermined);
+    _output_counts.assign(_output_indexes.size(), BigCount());
+    bool counted = true;
+    for (size_t pos = 0; pos != _output_indexes.size() && counted; ++pos) {
+        if (_level_order.empty() || _output_index != _output_indexes[pos]) {
+            _output_index = _output_indexes[pos];
+            levelize();
+        }
+        ModelCounter counter(*this, _threads_count, _stop);
+        size_t support = 0;
+        counted = counter.count(_output_index, _output_counts[pos], support);
+        if (counted) {
+            _output_counts[pos].shift_left(_original_inputs.size() - support);
+            _output_results[pos] = _output_counts[pos].is_zero() ? ValueEnum::False : ValueEnum::True;
+        }
+    }
+    if (_output_index != objective) {
+        _output_index = objective;
+        levelize();
+    }
+    set_gate_value(_output_index, _output_results.front());
+    return counted;
+}
+
+void CircuitSAT::_extract_part(VecGates const& roots, OperatorsEnum op, bool value, CircuitSAT& part) const {
+    /** copy of the cones of the roots with the output op(roots) == value, gates and inputs keep their names **/
+    GateIdx const outside = UINT32_MAX;
+    std::vector<GateIdx> new_indexes(get_gates_count(), outside);
+    std::vector<bool> in_part(get_gates_count(), false);
+    std::vector<GateIdx> stack(roots.begin(), roots.end());
+    while (!stack.empty()) {
+        GateIdx gate = stack.back();
+        stack.pop_back();
+        if (in_part[gate]) {
+            continue;
+        }
+        in_part[gate] = true;
+        for (GateIdx operand : get_gate(gate).get_operand_indexes()) {
+            stack.push_back(operand);
+        }
+    }
 
-    if (pos_input_gate == get_input_gate_indexes().size() - 1) {
+    for (GateIdx input : _input_gate_indexes) { // inputs first, in the order of this circuit
+        if (in_part[input]) {
+            new_indexes[input] = part.append_gate(get_gate(input).get_name());
+            part.set_gate_operator(new_indexes[input], OperatorsEnum::INPUT);
+            part.append_input_gate(new_indexes[input]);
+        }
+    }
+    for (size_t gate = 0; gate != get_gates_count(); ++gate) {
+        if (in_part[gate] && new_indexes[gate] == outside) {
+            new_indexes[gate] = part.append_gate(get_gate(gate).get_name());
+            part.set_gate_operator(new_indexes[gate], _operators[gate]);
+        }
+    }
+    for (size_t gate = 0; gate != get_gates_count(); ++gate) {
+        if (in_part[gate]) {
+            for (GateIdx operand : get_gate(gate).get_operand_indexes()) {
+                part.append_gate_operand_index(new_indexes[gate], new_indexes[operand]);
+            }
+        }
+    }
 
-        reset_value(*this);
-        calculate_gate(_output_index, *this);
-        return get_gate(_output_index).get_value() == ValueEnum::True;
+    GateIdx output = new_indexes[roots[0]];
+    if (roots.size() > 1) {
+        output = part.append_gate("part$objective");
+        part.set_gate_operator(output, op);
+        for (GateIdx root : roots) {
+            part.append_gate_operand_index(output, new_indexes[root]);
+        }
+    }
+    if (!value) {
+        GateIdx negation = part.append_gate("part$not");
+        part.set_gate_operator(negation, OperatorsEnum::NOT);
+        part.append_gate_operand_index(negation, output);
+        output = negation;
     }
+    part.set_idx_output(output);
+    part._output_indexes.assign(1, output);
+    part.build_adjacency();
+}
 
-    return _solve(pos_input_gate + 1, ValueEnum::True) || _solve(pos_input_gate + 1, ValueEnum::False);
+bool CircuitSAT::_solve_parts(ValueEnum& result) {
+    /**
+     * disjoint-support decomposition of the output: when the operands of an AND/OR output split into groups over
+     * disjoint inputs, every group is a separate circuit solved by the selected engine, so the enumeration covers
+     * 2^a + 2^b assignments instead of 2^(a+b). An AND needs every part, an OR one part (for the negated output
+     * the other way round); the parts run in parallel with _threads_count > 1 and share the threads, the first
+     * part that decides the result stops the others. The satisfying parts give the values of their inputs, the other inputs are False.
+     * false if the output doesn't decompose
+     **/
+    GateIdx root = _output_index;
+    bool value = true; // value the root must take
+    OperatorsEnum op = _operators[root];
+    while (op == OperatorsEnum::NOT || op == OperatorsEnum::BUFF) {
+        value ^= op == OperatorsEnum::NOT;
+        root = get_gate(root).get_operand_indexes()[0];
+        op = _operators[root];
+    }
+    if (op == OperatorsEnum::NAND || op == OperatorsEnum::NOR) {
+        value = !value;
+        op = op == OperatorsEnum::NAND ? OperatorsEnum::AND : OperatorsEnum::OR;
+    }
+    if (op != OperatorsEnum::AND && op != OperatorsEnum::OR) {
+        return false;
+    }
+
+    std::vector<VecGates> groups;
+    std::vector<size_t> supports;
+    SupportSplitter(*this).split(get_gate(root).get_operand_indexes(), groups, supports);
+    if (groups.size() < 2) {
+        return false;
+    }
+
+    bool every = (op == OperatorsEnum::AND) == value; // every part must be SAT, otherwise one is enough
+    ValueEnum decisive = every ? ValueEnum::False : ValueEnum::True;
+    std::vector<size_t> order(groups.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&supports](size_t lhs, size_t rhs) {
+        return supports[lhs] < supports[rhs]; // small parts first, they decide the result cheaply
+    });
+
+    std::vector<CircuitSAT> parts(groups.size());
+    std::vector<ValueEnum> results(groups.size(), ValueEnum::NotDetermined);
+    std::atomic<bool> parts_stop{false};
+    auto solve_part = [&](size_t pos, std::atomic<bool> const* stop, size_t part_threads) {
+        CircuitSAT& part = parts[pos];
+        _extract_part(groups[pos], op, value, part);
+        part.set_engine(_engine);
+        part.set_threads_count(part_threads);
+        part.set_stop(stop);
+        part.set_stats(_stats);
+        part._solve();
+        results[pos] = part.get_gate(part.get_output_index()).get_value();
+        if (results[pos] == decisive) {
+            parts_stop = true;
+        }
+    };
+
+    size_t threads_count = _threads_count == 0 ? ThreadPool::hardware_threads() : _threads_count;
+    if (threads_count == 1) {
+        for (size_t pos : order) {
+            if (parts_stop || _is_stopped()) {
+                break;
+            }
+            solve_part(pos, _stop, 1);
+        }
+    } else {
+        // the parts solved at the same time share the threads equally. The outer stop flag is passed on to the
+        // parts when the coordinator wakes up: on the end of every part, and periodically if there is a flag
+        size_t parallel_parts = std::min(threads_count, groups.size());
+        size_t part_threads = threads_count / parallel_parts;
+        ThreadPool pool(parallel_parts);
+        std::mutex mutex;
+        std::condition_variable part_done;
+        size_t finished = 0;
+        for (size_t pos : order) {
+            pool.submit([&, pos] {
+                if (!parts_stop) {
+                    solve_part(pos, &parts_stop, part_threads);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ++finished;
+                }
+                part_done.notify_one();
+            });
+        }
+        if (_stop != nullptr) {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!part_done.wait_for(lock, stop_check_period, [&] {return finished == groups.size();})) {
+                if (_is_stopped()) {
+                    parts_stop = true;
+                }
+            }
+        }
+        pool.wait();
+    }
+
+    if (std::find(results.begin(), results.end(), decisive) != results.end()) {
+        result = decisive;
+    } else if (std::find(results.begin(), results.end(), ValueEnum::NotDetermined) != results.end()) {
+        result = ValueEnum::NotDetermined;
+    } else {
+        result = every ? ValueEnum::True : ValueEnum::False;
+    }
+
+    if (result == ValueEnum::True) {
+        std::unordered_map<std::string_view, GateIdx> input_of;
+        for (GateIdx input : _input_gate_indexes) {
+            set_gate_value(input, ValueEnum::False);
+            input_of.emplace(get_gate(input).get_name(), input);
+        }
+        for (size_t pos = 0; pos != parts.size(); ++pos) {
+            if (results[pos] != ValueEnum::True) {
+                continue;
+            }
+            for (GateIdx input : parts[pos].get_input_gate_indexes()) {
+                set_gate_value(input_of.at(parts[pos].get_gate(input).get_name()),
+                               parts[pos].get_gate(input).get_value() == ValueEnum::True ? ValueEnum::True
+                                                                                          : ValueEnum::False);
+            }
+        }
+    }
+    return true;
 }
@@ -0,0 +1,95 @@
+#include "Counting.h"
+#include "Simulation.h"
+
+namespace {
+
+constexpr size_t max_depth = 256;   // deeper decompositions enumerate the component as a whole
+
+OperatorsEnum base_operator(OperatorsEnum op) {
+    switch (op) {
+        case OperatorsEnum::NAND:
+            return OperatorsEnum::AND;
+        case OperatorsEnum::NOR:
+            return OperatorsEnum::OR;
+        case OperatorsEnum::NXOR:
+            return OperatorsEnum::XOR;
+        default:
+            return op;
+    }
+}
+
+} // namespace
+
+bool ModelCounter::count(GateIdx root, BigCount& ones, size_t& support) {
+    return _count(root, ones, support, 0);
+}
+
+bool ModelCounter::_enumerate(VecGates const& roots, OperatorsEnum op, BigCount& ones, size_t& support) {
+    Simulation simulation(_circuit, roots, op);
+    support = simulation.get_program().input_positions.size();
+    ++_components;
+    return simulation.count(ones, _threads_count, _stop, _circuit.get_stats());
+}
+
+bool ModelCounter::_count(GateIdx gate, BigCount& ones, size_t& support, size_t depth) {
+    /** models of every component are combined with the numbers of its non-models: zeros = 2^support - ones **/
+    bool negated = false;
+    OperatorsEnum op = _circuit.get_gate(gate).get_operator_type();
+    while (op == OperatorsEnum::NOT || op == OperatorsEnum::BUFF) {
+        negated ^= op == OperatorsEnum::NOT;
+        gate = _circuit.get_gate(gate).get_operand_indexes()[0];
+        op = _circuit.get_gate(gate).get_operator_type();
+    }
+
+    std::vector<VecGates> groups;
+    std::vector<size_t> supports;
+    if (op != OperatorsEnum::INPUT && depth != max_depth) {
+        _splitter.split(_circuit.get_gate(gate).get_operand_indexes(), groups, supports);
+    }
+
+    if (op == OperatorsEnum::INPUT) {
+        ones = BigCount(1);
+        support = 1;
+    } else if (groups.size() < 2) {
+        if (!_enumerate({gate}, OperatorsEnum::BUFF, ones, support)) {
+            return false;
+        }
+    } else {
+        OperatorsEnum base = base_operator(op);
+        negated ^= op != base;
+        support = 0;
+        for (size_t pos = 0; pos != groups.size(); ++pos) {
+            BigCount group_ones;
+            size_t group_support = 0;
+            bool counted = groups[pos].size() == 1
+                           ? _count(groups[pos][0], group_ones, group_support, depth + 1)
+                           : _enumerate(groups[pos], base, group_ones, group_support);
+            if (!counted) {
+                return false;
+            }
+
+            if (pos == 0) {
+                ones = group_ones;
+            } else if (base == OperatorsEnum::AND) {
+                ones.mul(group_ones);
+            } else if (base == OperatorsEnum::OR) {
+                // zeros of the union are the products of zeros
+                BigCount zeros = BigCount::power_of_two(support).sub(ones);
+                zeros.mul(BigCount::power_of_two(group_support).sub(group_ones));
+                ones = BigCount::power_of_two(support + group_support).sub(zeros);
+            } else {
+                // XOR is True if exactly one side is True
+                BigCount zeros = BigCount::power_of_two(support).sub(ones);
+                BigCount group_zeros = BigCount::power_of_two(group_support).sub(group_ones);
+                ones.mul(group_zeros);
+                ones.add(zeros.mul(group_ones));
+            }
+            support += group_support;
+        }
+    }
+
+    if (negated) {
+        ones = BigCount::power_of_two(support).sub(ones);
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "BigCount.h"
+#include "Circuit.h"
+#include "Decomposition.h"
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+class ModelCounter {
+    /**
+     * Exact number of input assignments that set a gate of a levelized circuit (#SAT).
+     * AND/OR/XOR gates (and their negations) whose operands split into groups over disjoint inputs
+     * (SupportSplitter) are decomposed: the groups are independent components, their counts are combined by products, e.g.
+     * #AND = prod #ones, #OR = 2^n - prod #zeros. A component that doesn't split further is enumerated
+     * by the bit-parallel Simulation::count. Equal components are the same gate after structural hashing,
+     * so they need no separate cache.
+     * @private_fields:
+     *      _circuit            -- levelized circuit
+     *      _threads_count      -- threads of every enumeration (0 -- all cores)
+     *      _stop               -- flag checked by the enumerations, nullptr -- never set
+     *      _splitter           -- groups of operands over disjoint inputs
+     *      _components         -- components enumerated by simulation
+     *
+     * @methods:
+     *      count               -- number of models of the gate over the inputs of its cone (support),
+     *                             false if stop was set first
+     **/
+
+    public:
+        ModelCounter(CircuitSAT const& obj, size_t threads_count, std::atomic<bool> const* stop = nullptr)
+          : _circuit(obj), _threads_count(threads_count), _stop(stop), _splitter(obj) {};
+
+        bool count(GateIdx root, BigCount& ones, size_t& support);
+        [[nodiscard]] size_t get_components() const {return _components;}
+
+    private:
+        bool _count(GateIdx gate, BigCount& ones, size_t& support, size_t depth);
+        bool _enumerate(VecGates const& roots, OperatorsEnum op, BigCount& ones, size_t& support);
+
+        CircuitSAT const& _circuit;
+        size_t _threads_count;
+        std::atomic<bool> const* _stop;
+        SupportSplitter _splitter;
+        size_t _components = 0;
+};
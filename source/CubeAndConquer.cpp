@@ -0,0 +1,174 @@
+#include "CubeAndConquer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+constexpr size_t max_candidates = 64;   // gates probed by the lookahead in every cube
+constexpr size_t max_cube_depth = 12;
+constexpr size_t cubes_per_thread = 16;
+constexpr uint64_t interrupt_check_conflicts = 2000; // a cube is solved in slices to look at the interrupt flag
+
+bool cube_has_var(std::vector<Lit> const& cube, Var var) {
+    return std::any_of(cube.begin(), cube.end(), [var](Lit lit) {return lit_var(lit) == var;});
+}
+
+} // namespace
+
+CubeAndConquer::CubeAndConquer(CircuitSAT const& obj) : _circuit(obj), _encoding(_solver) {
+    _solver.add_clause({_encoding.encode(obj, obj.get_output_index())});
+
+    // gates with the largest fan-out are the most likely to split the cone into independent parts
+    std::vector<GateIdx> gates;
+    for (GateIdx gate = 0; gate != obj.get_gates_count(); ++gate) {
+        if (_encoding.is_encoded(gate) && gate != obj.get_output_index()) {
+            gates.push_back(gate);
+        }
+    }
+    std::stable_sort(gates.begin(), gates.end(), [&obj](GateIdx lhs, GateIdx rhs) {
+        return obj.get_gate(lhs).get_children_indexes().size() > obj.get_gate(rhs).get_children_indexes().size();
+    });
+    gates.resize(std::min(gates.size(), max_candidates));
+    for (GateIdx gate : gates) {
+        _candidates.push_back(_encoding.get_literal(gate));
+    }
+}
+
+ValueEnum CubeAndConquer::model_value(GateIdx gate) const {
+    return gate < _model.size() ? _model[gate] : ValueEnum::False;
+}
+
+bool CubeAndConquer::_lookahead(std::vector<Lit>& cube, Lit& split) {
+    /**
+     * choose the literal to split the cube by, failed literals are added to the cube.
+     * Returns false if the cube is refuted, split is lit_undef if no candidate is left
+     **/
+    split = lit_undef;
+    size_t best_score = 0;
+    for (Lit lit : _candidates) {
+        if (cube_has_var(cube, lit_var(lit))) {
+            continue;
+        }
+        size_t implied_true;
+        size_t implied_false;
+        bool ok_true = _solver.probe(cube, lit, implied_true);
+        bool ok_false = _solver.probe(cube, lit_neg(lit), implied_false);
+
+        if (!ok_true && !ok_false) {
+            return false;
+        }
+        if (!ok_true || !ok_false) {
+            Lit implied = ok_true ? lit : lit_neg(lit);
+            if ((ok_true ? implied_true : implied_false) != 0) { // not yet assigned by the cube
+                cube.push_back(implied);
+            }
+            continue;
+        }
+
+        size_t score = (implied_true + 1) * (implied_false + 1);
+        if (score > best_score) {
+            best_score = score;
+            split = lit;
+        }
+    }
+    return true;
+}
+
+std::vector<std::vector<Lit>> CubeAndConquer::_make_cubes(size_t max_depth, std::atomic<bool> const* interrupt) {
+    /** cubes are incomplete if interrupt was set, the caller has to check it **/
+    std::vector<std::vector<Lit>> cubes;
+    std::vector<std::pair<std::vector<Lit>, size_t>> stack{{{}, 0}};
+
+    while (!stack.empty() && !(interrupt != nullptr && interrupt->load(std::memory_order_relaxed))) {
+        auto [cube, depth] = std::move(stack.back());
+        stack.pop_back();
+
+        Lit split = lit_undef;
+        if (depth != max_depth && !_lookahead(cube, split)) {
+            continue; // refuted by lookahead
+        }
+        if (split == lit_undef) {
+            cubes.push_back(std::move(cube));
+            continue;
+        }
+        std::vector<Lit> negative = cube;
+        negative.push_back(lit_neg(split));
+        cube.push_back(split);
+        stack.emplace_back(std::move(negative), depth + 1);
+        stack.emplace_back(std::move(cube), depth + 1);
+    }
+    return cubes;
+}
+
+ValueEnum CubeAndConquer::solve(size_t threads_count, std::atomic<bool> const* interrupt) {
+    if (!_solver.is_ok()) {
+        return ValueEnum::False;
+    }
+
+    ThreadPool pool(threads_count);
+    size_t max_depth = 0;
+    while (max_depth != max_cube_depth && (size_t(1) << max_depth) < cubes_per_thread * pool.get_threads_count()) {
+        ++max_depth;
+    }
+    auto interrupted = [interrupt] {return interrupt != nullptr && interrupt->load(std::memory_order_relaxed);};
+    std::vector<std::vector<Lit>> cubes = _make_cubes(max_depth, interrupt);
+    _cubes_count = cubes.size();
+    if (interrupted()) {
+        return ValueEnum::NotDetermined;
+    }
+
+    SharedClauses shared;
+    std::atomic<bool> stop{false};
+    std::mutex mutex;
+    bool found = false;
+    std::atomic<bool> refuted_root{false};
+    std::atomic<size_t> refuted_cubes{0};
+
+    std::vector<CdclSolver> solvers(pool.get_threads_count(), _solver);
+    for (size_t worker = 0; worker != solvers.size(); ++worker) {
+        solvers[worker].set_stop(&stop);
+        solvers[worker].set_shared(&shared, worker);
+        solvers[worker].set_stats(_circuit.get_stats());
+        if (interrupt != nullptr) {
+            solvers[worker].set_conflict_budget(interrupt_check_conflicts);
+        }
+    }
+
+    for (std::vector<Lit> const& cube : cubes) {
+        pool.submit([&] {
+            CdclSolver& solver = solvers[ThreadPool::current_worker()];
+            ValueEnum result = ValueEnum::NotDetermined;
+            while (result == ValueEnum::NotDetermined && !stop.load(std::memory_order_relaxed) && !interrupted()) {
+                result = solver.solve(cube);
+            }
+
+            if (result == ValueEnum::True) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!found) {
+                    found = true;
+                    _model.assign(_circuit.get_gates_count(), ValueEnum::False);
+                    for (GateIdx gate = 0; gate != _circuit.get_gates_count(); ++gate) {
+                        if (_encoding.is_encoded(gate)) {
+                            _model[gate] = solver.model_value(lit_var(_encoding.get_literal(gate)));
+                        }
+                    }
+                }
+                stop = true;
+            } else if (result == ValueEnum::False && !solver.is_ok()) {
+                refuted_root = true;
+                stop = true; // refuted without assumptions, the other cubes are UNSAT too
+            } else if (result == ValueEnum::False) {
+                ++refuted_cubes;
+            }
+        });
+    }
+    pool.wait();
+
+    if (found) {
+        return ValueEnum::True;
+    }
+    return refuted_root || refuted_cubes == cubes.size() ? ValueEnum::False : ValueEnum::NotDetermined;
+}
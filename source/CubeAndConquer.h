@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Circuit.h"
+#include "Cdcl.h"
+#include "Tseitin.h"
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+class CubeAndConquer {
+    /**
+     * Parallel cube-and-conquer over the Tseitin encoding of the simplified circuit.
+     * The cube phase splits the search space by lookahead: every candidate gate is propagated with both values
+     * under the current cube and the gate that implies the most in both branches is used to split it.
+     * The conquer phase solves every cube by a copy of the CDCL solver under assumptions on a thread pool,
+     * the copies exchange learned units and binary clauses through SharedClauses.
+     * @private_fields:
+     *      _circuit            -- simplified circuit
+     *      _solver             -- solver with the encoded output cone, copied for every worker
+     *      _encoding           -- literals of the gates in _solver
+     *      _candidates         -- gates that may split cubes: the ones with the largest fan-out
+     *
+     * @methods:
+     *      solve               -- True if the output can be True, the model is kept in model_value;
+     *                             NotDetermined if interrupt was set before every cube was refuted
+     *      model_value         -- value of the gate in the found model
+     **/
+
+    public:
+        explicit CubeAndConquer(CircuitSAT const& obj);
+
+        ValueEnum solve(size_t threads_count, std::atomic<bool> const* interrupt = nullptr);
+        [[nodiscard]] ValueEnum model_value(GateIdx gate) const;
+        [[nodiscard]] size_t get_cubes_count() const {return _cubes_count;}
+
+    private:
+        std::vector<std::vector<Lit>> _make_cubes(size_t max_depth, std::atomic<bool> const* interrupt);
+        bool _lookahead(std::vector<Lit>& cube, Lit& split);
+
+        CircuitSAT const& _circuit;
+        CdclSolver _solver;
+        TseitinEncoding _encoding;
+        std::vector<Lit> _candidates;
+        std::vector<ValueEnum> _model;
+        size_t _cubes_count = 0;
+};
@@ -0,0 +1,53 @@
+#include "Decomposition.h"
+#include <numeric>
+
+void SupportSplitter::split(GateRange operands, std::vector<VecGates>& groups, std::vector<size_t>& supports) {
+    /**
+     * operands are joined when their cones meet: every operand marks its cone with its position and stops
+     * at the gates marked by an earlier one, so every gate is visited once per split
+     **/
+    size_t operands_count = operands.size();
+    std::vector<size_t> parent(operands_count);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](size_t pos) {
+        while (parent[pos] != pos) {
+            pos = parent[pos] = parent[parent[pos]];
+        }
+        return pos;
+    };
+
+    std::vector<size_t> inputs_of(operands_count, 0);
+    ++_current_stamp;
+    std::vector<GateIdx> stack;
+    for (size_t pos = 0; pos != operands_count; ++pos) {
+        stack.push_back(operands[pos]);
+        while (!stack.empty()) {
+            GateIdx gate = stack.back();
+            stack.pop_back();
+            if (_stamp[gate] == _current_stamp) {
+                parent[find(_owner[gate])] = find(pos);
+                continue;
+            }
+            _stamp[gate] = _current_stamp;
+            _owner[gate] = static_cast<uint32_t>(pos);
+            if (_circuit.get_gate(gate).get_operator_type() == OperatorsEnum::INPUT) {
+                ++inputs_of[pos];
+            }
+            for (GateIdx operand : _circuit.get_gate(gate).get_operand_indexes()) {
+                stack.push_back(operand);
+            }
+        }
+    }
+
+    std::vector<size_t> group_of(operands_count, SIZE_MAX);
+    for (size_t pos = 0; pos != operands_count; ++pos) {
+        size_t leader = find(pos);
+        if (group_of[leader] == SIZE_MAX) {
+            group_of[leader] = groups.size();
+            groups.emplace_back();
+            supports.push_back(0);
+        }
+        groups[group_of[leader]].push_back(operands[pos]);
+        supports[group_of[leader]] += inputs_of[pos];
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Circuit.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SupportSplitter {
+    /**
+     * Disjoint-support decomposition of a gate: its operands are grouped so that operands of different groups
+     * depend on disjoint sets of input gates. Such groups are independent sub-problems: the input space of the
+     * gate is the product of the input spaces of the groups.
+     * @private_fields:
+     *      _circuit            -- circuit with built adjacency
+     *      _owner, _stamp      -- operand that reached every gate in the current split, valid if its stamp is current
+     *
+     * @methods:
+     *      split               -- groups of the operands and the number of input gates every group depends on
+     **/
+
+    public:
+        explicit SupportSplitter(CircuitSAT const& obj)
+          : _circuit(obj), _owner(obj.get_gates_count(), 0), _stamp(obj.get_gates_count(), 0) {};
+
+        void split(GateRange operands, std::vector<VecGates>& groups, std::vector<size_t>& supports);
+
+    private:
+        CircuitSAT const& _circuit;
+        std::vector<uint32_t> _owner;
+        std::vector<uint32_t> _stamp;
+        uint32_t _current_stamp = 0;
+};
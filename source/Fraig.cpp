@@ -0,0 +1,244 @@
+#include "Fraig.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+constexpr size_t random_words = 4;          // 256 random patterns
+constexpr size_t cex_words = 4;             // up to 256 counterexample patterns
+constexpr uint64_t conflict_budget = 500;   // conflicts allowed to one equivalence check
+constexpr size_t max_checks = 10000;
+constexpr size_t prioritized_depth = 4;     // levels of the cone of a checked pair decided first
+
+uint64_t next_random(uint64_t& state) {
+    /** xorshift64*, the patterns are the same on every run **/
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1Dull;
+}
+
+} // namespace
+
+Fraig::Fraig(Aig const& aig)
+        : _aig(aig), _stride(random_words + cex_words), _signatures(aig.get_nodes_count() * _stride, 0),
+          _encoding(_solver) {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (uint32_t input : _aig.get_inputs()) {
+        for (size_t word = 0; word != random_words; ++word) {
+            _signatures[input * _stride + word] = next_random(state);
+        }
+    }
+    for (size_t word = 0; word != _stride; ++word) {
+        _simulate_word(word);
+    }
+    _build_classes();
+}
+
+void Fraig::_simulate_word(size_t word) {
+    auto value = [this, word](AigLit lit) {
+        uint64_t value = _signatures[aig_node(lit) * _stride + word];
+        return aig_is_complemented(lit) ? ~value : value;
+    };
+    for (uint32_t node = 1; node != _aig.get_nodes_count(); ++node) {
+        if (_aig.is_and(node)) {
+            _signatures[node * _stride + word] = value(_aig.get_fanin0(node)) & value(_aig.get_fanin1(node));
+        }
+    }
+}
+
+void Fraig::_build_classes() {
+    /** nodes are grouped by the hash of the normalized signature, equal signatures inside a group form a class **/
+    size_t nodes_count = _aig.get_nodes_count();
+    _phases.assign(nodes_count, false);
+    std::vector<uint64_t> hashes(nodes_count, 0);
+    for (size_t node = 0; node != nodes_count; ++node) {
+        _phases[node] = _signatures[node * _stride] & 1;
+        uint64_t mask = _phases[node] ? ~uint64_t(0) : 0;
+        uint64_t hash = 0;
+        for (size_t word = 0; word != _stride; ++word) {
+            hash = (hash ^ (_signatures[node * _stride + word] ^ mask)) * 0x100000001B3ull;
+            hash ^= hash >> 29;
+        }
+        hashes[node] = hash;
+    }
+
+    std::vector<uint32_t> order(nodes_count);
+    for (uint32_t node = 0; node != nodes_count; ++node) {
+        order[node] = node;
+    }
+    std::sort(order.begin(), order.end(), [&hashes](uint32_t lhs, uint32_t rhs) {
+        return hashes[lhs] != hashes[rhs] ? hashes[lhs] < hashes[rhs] : lhs < rhs;
+    });
+
+    auto same_signature = [this](uint32_t lhs, uint32_t rhs) {
+        uint64_t mask = _phases[lhs] != _phases[rhs] ? ~uint64_t(0) : 0;
+        for (size_t word = 0; word != _stride; ++word) {
+            if (_signatures[lhs * _stride + word] != (_signatures[rhs * _stride + word] ^ mask)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    _class_leader.assign(nodes_count, 0);
+    std::vector<uint32_t> leaders;
+    for (size_t begin = 0, end = 0; begin != nodes_count; begin = end) {
+        for (end = begin; end != nodes_count && hashes[order[end]] == hashes[order[begin]]; ++end) {}
+        leaders.clear();
+        for (size_t pos = begin; pos != end; ++pos) {
+            uint32_t node = order[pos];
+            auto it = std::find_if(leaders.begin(), leaders.end(), [&](uint32_t leader) {
+                return same_signature(leader, node);
+            });
+            if (it == leaders.end()) {
+                leaders.push_back(node);
+                _class_leader[node] = node;
+            } else {
+                _class_leader[node] = *it;
+            }
+        }
+    }
+}
+
+void Fraig::_prioritize_cone(Aig const& swept, AigLit lhs, AigLit rhs) {
+    /**
+     * the solver decides on the nodes close to the checked pair first, far nodes are mostly
+     * already merged and deciding them first only delays the conflict
+     **/
+    std::vector<uint32_t> layer{aig_node(lhs), aig_node(rhs)};
+    std::vector<uint32_t> cone;
+    for (size_t depth = 0; depth != prioritized_depth && !layer.empty(); ++depth) {
+        std::vector<uint32_t> next;
+        for (uint32_t node : layer) {
+            if (std::find(cone.begin(), cone.end(), node) != cone.end()) {
+                continue;
+            }
+            cone.push_back(node);
+            if (swept.is_and(node)) {
+                next.push_back(aig_node(swept.get_fanin0(node)));
+                next.push_back(aig_node(swept.get_fanin1(node)));
+            }
+        }
+        layer = std::move(next);
+    }
+    for (auto it = cone.rbegin(); it != cone.rend(); ++it) {
+        _solver.prioritize(_encoding.get_var(*it));
+    }
+}
+
+ValueEnum Fraig::_prove_equal(Aig const& swept, AigLit lhs, AigLit rhs) {
+    /**
+     * True if lhs == rhs is proven, the equivalence is added to the solver for later checks;
+     * False if the solver found a distinguishing assignment (its model); NotDetermined if the budget is exhausted
+     **/
+    if (aig_node(lhs) == 0) {
+        std::swap(lhs, rhs);
+    }
+    uint64_t remaining = _conflicts_budget == 0 ? conflict_budget : _conflicts_budget - _solver.get_conflicts();
+    _solver.set_conflict_budget(std::min(conflict_budget, remaining));
+    Lit a = _encoding.encode(swept, lhs);
+
+    if (aig_node(rhs) == 0) {
+        Lit expected = rhs == aig_true ? a : lit_neg(a);
+        ValueEnum result = _solver.solve({lit_neg(expected)});
+        if (result == ValueEnum::False) {
+            _solver.add_clause({expected});
+            return ValueEnum::True;
+        }
+        return result == ValueEnum::True ? ValueEnum::False : ValueEnum::NotDetermined;
+    }
+
+    Lit b = _encoding.encode(swept, rhs);
+    _prioritize_cone(swept, lhs, rhs);
+    for (int side = 0; side != 2; ++side, std::swap(a, b)) {
+        ValueEnum result = _solver.solve({a, lit_neg(b)});
+        if (result != ValueEnum::False) {
+            return result == ValueEnum::True ? ValueEnum::False : ValueEnum::NotDetermined;
+        }
+    }
+    _solver.add_clause({lit_neg(a), b});
+    _solver.add_clause({a, lit_neg(b)});
+    return ValueEnum::True;
+}
+
+void Fraig::_add_counterexample(std::vector<AigLit> const& new_lits) {
+    /** one more pattern from the model of the solver, the classes are rebuilt with it **/
+    if (_cex_count == cex_words * 64) {
+        return;
+    }
+    size_t word = random_words + _cex_count / 64;
+    uint64_t bit = uint64_t(1) << (_cex_count % 64);
+    for (uint32_t input : _aig.get_inputs()) {
+        AigLit lit = new_lits[input];
+        if (lit == aig_undef || !_encoding.is_encoded(aig_node(lit))) {
+            continue; // not in the cone of the checked pair, any value distinguishes them
+        }
+        bool value = _solver.model_value(_encoding.get_var(aig_node(lit))) == ValueEnum::True;
+        if (value != aig_is_complemented(lit)) {
+            _signatures[input * _stride + word] |= bit;
+        }
+    }
+    ++_cex_count;
+    _simulate_word(word);
+    _build_classes();
+}
+
+bool Fraig::_budget_spent(std::chrono::steady_clock::time_point start) const {
+    return (_conflicts_budget != 0 && _solver.get_conflicts() >= _conflicts_budget) ||
+           (_seconds_budget != 0 &&
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= _seconds_budget);
+}
+
+Aig Fraig::run(AigLit& root, std::vector<AigLit>& lits) {
+    /**
+     * the graph is rebuilt in topological order, every node that has an earlier node in its class
+     * is replaced by that node's literal when the equivalence is proven
+     **/
+    Aig swept;
+    std::vector<AigLit> new_lits(_aig.get_nodes_count(), aig_undef);
+    new_lits[0] = aig_false;
+    auto remap = [&new_lits](AigLit lit) {
+        return new_lits[aig_node(lit)] ^ static_cast<AigLit>(aig_is_complemented(lit));
+    };
+
+    size_t checks = 0;
+    bool spent = false;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t node = 1; node != _aig.get_nodes_count(); ++node) {
+        if (!_aig.is_and(node)) {
+            new_lits[node] = swept.create_input();
+            continue;
+        }
+        AigLit lit = swept.make_and(remap(_aig.get_fanin0(node)), remap(_aig.get_fanin1(node)));
+
+        uint32_t leader = _class_leader[node];
+        bool stopped = spent || (_stop != nullptr && _stop->load(std::memory_order_relaxed));
+        if (leader != node && checks != max_checks && !stopped) {
+            AigLit target = new_lits[leader] ^ static_cast<AigLit>(_phases[node] != _phases[leader]);
+            if (lit != target) {
+                ++checks;
+                ValueEnum result = _prove_equal(swept, lit, target);
+                if (result == ValueEnum::True) {
+                    lit = target;
+                    ++_merged;
+                } else if (result == ValueEnum::False) {
+                    ++_refuted;
+                    _add_counterexample(new_lits);
+                } else {
+                    ++_undecided;
+                }
+                spent = _budget_spent(start);
+            }
+        }
+        new_lits[node] = lit;
+    }
+
+    root = remap(root);
+    for (AigLit& lit : lits) {
+        if (lit != aig_undef) {
+            lit = remap(lit);
+        }
+    }
+    return swept;
+}
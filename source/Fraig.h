@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Aig.h"
+#include "Cdcl.h"
+#include "Tseitin.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr uint64_t sweeping_conflicts = 2000;  // conflicts of all equivalence checks of one sweeping
+constexpr double sweeping_seconds = 0.05;      // time of the equivalence checks of one sweeping
+constexpr size_t max_swept_ands = 200000;      // larger graphs are not swept, only simulating them costs more
+
+class Fraig {
+    /**
+     * SAT sweeping of an AIG: nodes with the same random simulation signature (up to complement) form
+     * candidate equivalence classes, every candidate is checked against the first node of its class by an
+     * incremental CDCL solver under assumptions and merged if the equivalence is proven.
+     * A counterexample is simulated as one more pattern and splits the classes it distinguishes.
+     * @private_fields:
+     *      _aig                -- graph being swept
+     *      _signatures         -- simulation words of every node: random words, then counterexample words
+     *      _phases             -- value of the node on the first pattern, signatures are compared in this phase
+     *      _class_leader       -- first node with the same normalized signature, the node itself if none
+     *      _cex_count          -- counterexample patterns added to the signatures
+     *      _solver, _encoding  -- solver over the Tseitin encoding of the new graph and variables of its nodes
+     *
+     * @methods:
+     *      run                 -- build the swept graph, root and lits are remapped to it
+     *      set_stop            -- flag set from outside, the remaining candidates are left unmerged once it is set
+     *      set_budget          -- conflicts and seconds of the whole run (0 -- unlimited), the remaining candidates
+     *                             are left unmerged once either is spent
+     **/
+
+    public:
+        explicit Fraig(Aig const& aig);
+
+        Aig run(AigLit& root, std::vector<AigLit>& lits);
+        void set_stop(std::atomic<bool> const* stop)       {_stop = stop; _solver.set_stop(stop);}
+        void set_budget(uint64_t conflicts, double seconds) {_conflicts_budget = conflicts; _seconds_budget = seconds;}
+
+        [[nodiscard]] size_t get_merged()          const {return _merged;}
+        [[nodiscard]] size_t get_refuted()         const {return _refuted;}
+        [[nodiscard]] size_t get_undecided()       const {return _undecided;}
+
+    private:
+        void _simulate_word(size_t word);
+        void _build_classes();
+        void _add_counterexample(std::vector<AigLit> const& new_lits);
+        ValueEnum _prove_equal(Aig const& swept, AigLit lhs, AigLit rhs);
+        void _prioritize_cone(Aig const& swept, AigLit lhs, AigLit rhs);
+        [[nodiscard]] bool _budget_spent(std::chrono::steady_clock::time_point start) const;
+
+        Aig const& _aig;
+        size_t _stride;
+        std::vector<uint64_t> _signatures;
+        std::vector<bool> _phases;
+        std::vector<uint32_t> _class_leader;
+        size_t _cex_count = 0;
+
+        CdclSolver _solver;
+        AigEncoding _encoding;
+        std::atomic<bool> const* _stop = nullptr;
+        uint64_t _conflicts_budget = 0;
+        double _seconds_budget = 0;
+
+        size_t _merged = 0;
+        size_t _refuted = 0;
+        size_t _undecided = 0;
+};
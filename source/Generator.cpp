@@ -0,0 +1,242 @@
+#include "Generator.h"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+constexpr std::pair<std::string_view, FamilyEnum> family_names[] = { /** encode family name to enum **/
+        {"adder",      FamilyEnum::ADDER},
+        {"multiplier", FamilyEnum::MULTIPLIER},
+        {"random",     FamilyEnum::RANDOM},
+        {"xor",        FamilyEnum::XOR_CHAIN},
+        {"buff",       FamilyEnum::BUFF_CHAIN},
+        {"duplicates", FamilyEnum::DUPLICATES}
+};
+
+constexpr std::string_view random_operators[] = {"AND", "OR", "XOR", "NAND", "NOR", "NXOR", "NOT", "BUFF"};
+
+constexpr size_t random_window = 16;    // most operands of the random DAG are recent gates, so the DAG is deep
+
+} // namespace
+
+bool CircuitGenerator::find_family(std::string_view name, FamilyEnum& family) {
+    for (auto const& [family_name, value] : family_names) {
+        if (family_name == name) {
+            family = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view CircuitGenerator::family_name(FamilyEnum family) {
+    for (auto const& [name, value] : family_names) {
+        if (value == family) {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+void CircuitGenerator::generate(FamilyEnum family, size_t size, std::ostream& out) {
+    _text.clear();
+    _gates_count = 0;
+    switch (family) {
+        case FamilyEnum::ADDER:
+            _adder(size);
+            break;
+        case FamilyEnum::MULTIPLIER:
+            _multiplier(size);
+            break;
+        case FamilyEnum::RANDOM:
+            _random_dag(size);
+            break;
+        case FamilyEnum::XOR_CHAIN:
+            _xor_chain(size);
+            break;
+        case FamilyEnum::BUFF_CHAIN:
+            _buff_chain(size);
+            break;
+        case FamilyEnum::DUPLICATES:
+            _duplicates(size);
+            break;
+    }
+    out << _text;
+}
+
+std::string CircuitGenerator::_input(std::string name) {
+    _text += "INPUT(" + name + ")\n";
+    return name;
+}
+
+void CircuitGenerator::_output(std::string const& name) {
+    _text += "OUTPUT(" + name + ")\n";
+}
+
+std::string CircuitGenerator::_gate(std::string_view op, Bits const& operands) {
+    std::string name = "g" + std::to_string(_gates_count++);
+    _text += name + " = ";
+    _text += op;
+    for (size_t pos = 0; pos != operands.size(); ++pos) {
+        _text += (pos == 0 ? "(" : ", ") + operands[pos];
+    }
+    _text += ")\n";
+    return name;
+}
+
+CircuitGenerator::Bits CircuitGenerator::_inputs_vector(std::string const& prefix, size_t count) {
+    Bits bits;
+    for (size_t pos = 0; pos != count; ++pos) {
+        bits.push_back(_input(prefix + std::to_string(pos)));
+    }
+    return bits;
+}
+
+std::string CircuitGenerator::_miter(Bits const& lhs, Bits const& rhs) {
+    /** OR of the differences of the bits, bits of the longer side without a pair must be 0 **/
+    Bits differences;
+    for (size_t pos = 0; pos != std::max(lhs.size(), rhs.size()); ++pos) {
+        if (pos >= lhs.size() || pos >= rhs.size()) {
+            differences.push_back(pos < lhs.size() ? lhs[pos] : rhs[pos]);
+        } else {
+            differences.push_back(_gate("XOR", {lhs[pos], rhs[pos]}));
+        }
+    }
+    assert(!differences.empty() && "Miter of empty words");
+    return differences.size() == 1 ? differences[0] : _gate("OR", differences);
+}
+
+void CircuitGenerator::_full_adder(std::string const& lhs, std::string const& rhs, std::string const& carry_in,
+                                   bool nand, std::string& sum, std::string& carry_out) {
+    if (!nand) {
+        std::string half = _gate("XOR", {lhs, rhs});
+        sum = _gate("XOR", {half, carry_in});
+        carry_out = _gate("OR", {_gate("AND", {lhs, rhs}), _gate("AND", {half, carry_in})});
+        return;
+    }
+    // nine NAND gates, the same function without XOR
+    std::string both = _gate("NAND", {lhs, rhs});
+    std::string half = _gate("NAND", {_gate("NAND", {lhs, both}), _gate("NAND", {rhs, both})});
+    std::string carried = _gate("NAND", {half, carry_in});
+    sum = _gate("NAND", {_gate("NAND", {half, carried}), _gate("NAND", {carry_in, carried})});
+    carry_out = _gate("NAND", {both, carried});
+}
+
+CircuitGenerator::Bits CircuitGenerator::_add(Bits const& lhs, Bits const& rhs, bool nand) {
+    /** ripple-carry sum of little-endian words of any lengths, one bit longer than the longest word **/
+    Bits sum;
+    std::string carry;
+    for (size_t pos = 0; pos != std::max(lhs.size(), rhs.size()); ++pos) {
+        Bits bits;
+        for (std::string const& bit : {pos < lhs.size() ? lhs[pos] : "", pos < rhs.size() ? rhs[pos] : "", carry}) {
+            if (!bit.empty()) {
+                bits.push_back(bit);
+            }
+        }
+        if (bits.size() == 3) {
+            std::string sum_bit;
+            _full_adder(bits[0], bits[1], bits[2], nand, sum_bit, carry);
+            sum.push_back(sum_bit);
+        } else if (bits.size() == 2) {
+            sum.push_back(_gate("XOR", bits));
+            carry = _gate("AND", bits);
+        } else {
+            sum.push_back(bits[0]);
+            carry.clear();
+        }
+    }
+    if (!carry.empty()) {
+        sum.push_back(carry);
+    }
+    return sum;
+}
+
+CircuitGenerator::Bits CircuitGenerator::_multiply(Bits const& lhs, Bits const& rhs, bool nand) {
+    /** array multiplier: the partial product of every bit of rhs is added to the high bits of the accumulator **/
+    Bits product;
+    for (size_t row = 0; row != rhs.size(); ++row) {
+        Bits partial;
+        for (std::string const& bit : lhs) {
+            partial.push_back(_gate("AND", {bit, rhs[row]}));
+        }
+        if (row == 0) {
+            product = partial;
+            continue;
+        }
+        Bits high(product.begin() + static_cast<std::ptrdiff_t>(row), product.end());
+        product.resize(row);
+        for (std::string& bit : _add(high, partial, nand)) {
+            product.push_back(std::move(bit));
+        }
+    }
+    return product;
+}
+
+void CircuitGenerator::_adder(size_t bits) {
+    Bits lhs = _inputs_vector("a", bits);
+    Bits rhs = _inputs_vector("b", bits);
+    _output(_miter(_add(lhs, rhs, false), _add(rhs, lhs, true)));
+}
+
+void CircuitGenerator::_multiplier(size_t bits) {
+    Bits lhs = _inputs_vector("a", bits);
+    Bits rhs = _inputs_vector("b", bits);
+    _output(_miter(_multiply(lhs, rhs, false), _multiply(rhs, lhs, true)));
+}
+
+void CircuitGenerator::_random_dag(size_t gates) {
+    Bits names = _inputs_vector("x", _inputs);
+    for (size_t gate = 0; gate != gates; ++gate) {
+        std::string_view op = random_operators[_random() % std::size(random_operators)];
+        size_t arity = op == "NOT" || op == "BUFF" ? 1 : _arity;
+        Bits operands;
+        for (size_t pos = 0; pos != arity; ++pos) {
+            size_t window = _random() % 10 < 7 ? std::min(names.size(), random_window) : names.size();
+            operands.push_back(names[names.size() - 1 - _random() % window]);
+        }
+        names.push_back(_gate(op, operands));
+    }
+    _output(names.back());
+}
+
+void CircuitGenerator::_xor_chain(size_t inputs) {
+    Bits bits = _inputs_vector("x", inputs);
+    std::string chain = bits[0];
+    for (size_t pos = 1; pos != bits.size(); ++pos) {
+        chain = _gate("XOR", {chain, bits[pos]});
+    }
+    while (bits.size() != 1) {
+        Bits level;
+        for (size_t pos = 0; pos + 1 < bits.size(); pos += 2) {
+            level.push_back(_gate("XOR", {bits[pos], bits[pos + 1]}));
+        }
+        if (bits.size() % 2 == 1) {
+            level.push_back(bits.back());
+        }
+        bits = std::move(level);
+    }
+    _output(_miter({chain}, bits));
+}
+
+void CircuitGenerator::_buff_chain(size_t depth) {
+    std::string chain = _input("x0");
+    std::string other = _input("x1");
+    for (size_t pos = 0; pos != depth; ++pos) {
+        chain = _gate("BUFF", {chain});
+    }
+    _output(_gate("AND", {chain, other}));
+}
+
+void CircuitGenerator::_duplicates(size_t copies) {
+    /** AND gates over the neighbouring inputs repeat with swapped operands, the objective is their conjunction **/
+    Bits bits = _inputs_vector("x", _inputs);
+    Bits duplicates;
+    for (size_t copy = 0; copy != copies; ++copy) {
+        size_t pos = copy % (bits.size() - 1);
+        bool swapped = copy / (bits.size() - 1) % 2 == 1;
+        duplicates.push_back(_gate("AND", {bits[pos + swapped], bits[pos + !swapped]}));
+    }
+    _output(_gate("AND", duplicates));
+}
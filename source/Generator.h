@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class FamilyEnum { /** parametric circuit families of CircuitGenerator **/
+    ADDER,          // miter of two ripple-carry adders of size bits (XOR and NAND full adders), UNSAT
+    MULTIPLIER,     // miter of two array multipliers of size bits, a * b against b * a, UNSAT
+    RANDOM,         // random DAG of size gates with the given arity over the given number of inputs
+    XOR_CHAIN,      // miter of a chain and a balanced tree computing the parity of size inputs, UNSAT
+    BUFF_CHAIN,     // chain of size BUFF gates from an input, the objective is AND of its end and another input
+    DUPLICATES      // size copies of the same AND gates under one wide AND, one model
+};
+
+class CircuitGenerator {
+    /**
+     * Generator of parametric circuits in the BENCH format for benchmarks: arithmetic miters stress the solving
+     * engines, chains and duplicates stress parsing and simplification. The output is the same for the same seed.
+     * @private_fields:
+     *      _random             -- source of the random DAG operators and operands
+     *      _arity              -- operands of every non-unary gate of the random DAG
+     *      _inputs             -- inputs of the random DAG and of the duplicates
+     *      _text               -- BENCH text of the circuit being generated
+     *      _gates_count        -- gates defined so far, gives fresh names "g<number>"
+     *
+     * @methods:
+     *      find_family         -- family by its name: adder, multiplier, random, xor, buff, duplicates
+     *      family_name         -- name of the family for reports
+     *      generate            -- write the circuit of the family with the size parameter to out
+     **/
+
+    public:
+        explicit CircuitGenerator(uint64_t seed, size_t arity = 2, size_t inputs = 20)
+          : _random(seed), _arity(arity), _inputs(inputs) {};
+
+        static bool find_family(std::string_view name, FamilyEnum& family);
+        static std::string_view family_name(FamilyEnum family);
+        void generate(FamilyEnum family, size_t size, std::ostream& out);
+
+    private:
+        using Bits = std::vector<std::string>;
+
+        std::string _input(std::string name);
+        void _output(std::string const& name);
+        std::string _gate(std::string_view op, Bits const& operands);
+        Bits _inputs_vector(std::string const& prefix, size_t count);
+        std::string _miter(Bits const& lhs, Bits const& rhs);
+        void _full_adder(std::string const& lhs, std::string const& rhs, std::string const& carry_in, bool nand,
+                         std::string& sum, std::string& carry_out);
+        Bits _add(Bits const& lhs, Bits const& rhs, bool nand);
+        Bits _multiply(Bits const& lhs, Bits const& rhs, bool nand);
+
+        void _adder(size_t bits);
+        void _multiplier(size_t bits);
+        void _random_dag(size_t gates);
+        void _xor_chain(size_t inputs);
+        void _buff_chain(size_t depth);
+        void _duplicates(size_t copies);
+
+        std::mt19937_64 _random;
+        size_t _arity;
+        size_t _inputs;
+        std::string _text;
+        size_t _gates_count = 0;
+};
@@ -0,0 +1,118 @@
+#include "Incremental.h"
+#include "Fraig.h"
+#include <cassert>
+
+IncrementalSolver::IncrementalSolver(CircuitSAT& circuit) : _circuit(circuit), _encoding(_solver) {
+    /** the whole netlist is converted, not only the output cone: queries may assume any gate **/
+    _gate_lits.assign(circuit.get_gates_count(), aig_undef);
+    for (GateIdx input : circuit.get_input_gate_indexes()) {
+        _gate_lits[input] = _aig.create_input();
+    }
+    for (GateIdx gate = 0; gate != circuit.get_gates_count(); ++gate) {
+        if (_gate_lits[gate] == aig_undef) {
+            circuit.cone_to_aig(_aig, _gate_lits, gate);
+        }
+        _names.emplace(circuit.get_gate(gate).get_name(), gate);
+    }
+
+    if (circuit.get_sweeping() && _aig.get_ands_count() <= max_swept_ands) {
+        PhaseTimer timer(circuit.get_stats(), PhaseEnum::SWEEPING);
+        AigLit root = _gate_lits.at(circuit.get_output_index());
+        Fraig fraig(_aig);
+        fraig.set_stop(circuit.get_stop());
+        fraig.set_budget(sweeping_conflicts, sweeping_seconds);
+        _aig = fraig.run(root, _gate_lits);
+        _merged_by_sweeping = fraig.get_merged();
+    }
+    _solver.set_stop(circuit.get_stop());
+    _solver.set_stats(circuit.get_stats());
+}
+
+GateIdx IncrementalSolver::find_gate(std::string_view name) const {
+    auto it = _names.find(std::string(name));
+    return it == _names.end() ? UINT32_MAX : it->second;
+}
+
+GateIdx IncrementalSolver::add_gate(std::string_view name, OperatorsEnum op, std::vector<GateIdx> const& operands) {
+    assert(find_gate(name) == UINT32_MAX && "Gate with this name already exists");
+    assert(op != OperatorsEnum::UNKNOWN && "Gate has no operator");
+    assert((op == OperatorsEnum::INPUT) == operands.empty() && "Wrong number of operands");
+    assert((op != OperatorsEnum::NOT && op != OperatorsEnum::BUFF) || operands.size() == 1);
+
+    AigLit lit;
+    if (op == OperatorsEnum::INPUT) {
+        lit = _aig.create_input();
+    } else {
+        std::vector<AigLit> operand_lits;
+        for (GateIdx operand : operands) {
+            operand_lits.push_back(_gate_lits.at(operand));
+        }
+        lit = CircuitSAT::gate_to_aig(_aig, op, operand_lits);
+    }
+
+    GateIdx gate = _circuit.append_gate(name);
+    _circuit.set_gate_operator(gate, op);
+    if (op == OperatorsEnum::INPUT) {
+        _circuit.append_input_gate(gate);
+    }
+    for (GateIdx operand : operands) {
+        _circuit.append_gate_operand_index(gate, operand);
+    }
+    _adjacency_stale = true;
+
+    _gate_lits.push_back(lit);
+    _names.emplace(name, gate);
+    return gate;
+}
+
+Lit IncrementalSolver::_literal(GateIdx gate) {
+    return _encoding.encode(_aig, _gate_lits.at(gate));
+}
+
+bool IncrementalSolver::add_constraint(GateIdx gate, bool value) {
+    /** the model of the last query may violate the constraint and doesn't cover the variables encoded for it **/
+    _result = ValueEnum::NotDetermined;
+    _model.clear();
+    Lit lit = _literal(gate);
+    return _solver.add_clause({value ? lit : lit_neg(lit)});
+}
+
+ValueEnum IncrementalSolver::solve(std::vector<Assumption> const& assumptions) {
+    /** only the cones of the assumed gates are encoded, the ones encoded by earlier queries are reused **/
+    if (_adjacency_stale) { // the circuit stays consistent for its other users
+        _circuit.build_adjacency();
+        _adjacency_stale = false;
+    }
+
+    std::vector<Lit> lits;
+    for (auto const& [gate, value] : assumptions) {
+        Lit lit = _literal(gate);
+        lits.push_back(value ? lit : lit_neg(lit));
+    }
+    ++_queries;
+    _model.clear();
+    _result = _solver.solve(lits);
+    return _result;
+}
+
+ValueEnum IncrementalSolver::model_value(GateIdx gate) {
+    /** nodes outside the encoded cones are evaluated from the model, inputs that aren't encoded are False **/
+    if (_result != ValueEnum::True) {
+        return ValueEnum::NotDetermined;
+    }
+    if (_model.size() != _aig.get_nodes_count()) { // gates added after the query have nodes past the old model
+        _model.assign(_aig.get_nodes_count(), false);
+        for (uint32_t node = 1; node != _aig.get_nodes_count(); ++node) {
+            if (_encoding.is_encoded(node)) {
+                _model[node] = _solver.model_value(_encoding.get_var(node)) == ValueEnum::True;
+            } else if (_aig.is_and(node)) {
+                AigLit lhs = _aig.get_fanin0(node);
+                AigLit rhs = _aig.get_fanin1(node);
+                _model[node] = (_model[aig_node(lhs)] != aig_is_complemented(lhs))
+                               && (_model[aig_node(rhs)] != aig_is_complemented(rhs));
+            }
+        }
+    }
+    AigLit lit = _gate_lits.at(gate);
+    return _model[aig_node(lit)] != aig_is_complemented(lit) ? ValueEnum::True : ValueEnum::False;
+}
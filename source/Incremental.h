@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Aig.h"
+#include "Circuit.h"
+#include "Cdcl.h"
+#include "Tseitin.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using Assumption = std::pair<GateIdx, bool>; // gate and the value it is forced to
+
+class IncrementalSolver {
+    /**
+     * Many related queries on one netlist: the circuit is converted to an AIG once and functionally equivalent
+     * nodes are merged by SAT sweeping (unless it is switched off in the circuit) under the budget of simplify,
+     * a persistent CDCL solver receives the encoding of the cones the queries need. Gates and permanent
+     * constraints can be added between the queries, every query is solved under assumptions on gate values,
+     * learned clauses and the encoding are kept for the next ones.
+     * The circuit is used as parsed: simplify removes and renames gates, it must not be called on the circuit.
+     * @private_fields:
+     *      _circuit            -- circuit the new gates are appended to
+     *      _aig, _gate_lits    -- swept graph and the literal of every gate in it
+     *      _solver, _encoding  -- persistent solver and variables of the encoded nodes
+     *      _names              -- gate index by name
+     *      _adjacency_stale    -- gates were added after the adjacency of the circuit was built
+     *      _result             -- result of the last query
+     *      _model              -- value of every AIG node in the model of the last query, computed on demand
+     *
+     * @methods:
+     *      find_gate           -- index of the gate with the name, UINT32_MAX if there is none
+     *      add_gate            -- new gate with a new name over existing gates, INPUT creates a new input
+     *      add_constraint      -- the gate keeps the value in all later queries, false if they became UNSAT
+     *      solve               -- True if the assumptions can hold together with the constraints, False otherwise
+     *      model_value         -- value of the gate in the model of the last satisfiable query (gates added
+     *                             after it too), NotDetermined once a constraint was added after the query
+     **/
+
+    public:
+        explicit IncrementalSolver(CircuitSAT& circuit);
+
+        IncrementalSolver(IncrementalSolver const&) = delete;
+        IncrementalSolver& operator=(IncrementalSolver const&) = delete;
+
+        [[nodiscard]] GateIdx find_gate(std::string_view name) const;
+        GateIdx add_gate(std::string_view name, OperatorsEnum op, std::vector<GateIdx> const& operands);
+        bool add_constraint(GateIdx gate, bool value);
+        ValueEnum solve(std::vector<Assumption> const& assumptions = {});
+        [[nodiscard]] ValueEnum model_value(GateIdx gate);
+
+        [[nodiscard]] size_t get_merged_by_sweeping()      const {return _merged_by_sweeping;}
+        [[nodiscard]] size_t get_queries()                 const {return _queries;}
+        [[nodiscard]] CdclSolver const& get_solver()       const {return _solver;}
+
+    private:
+        Lit _literal(GateIdx gate);
+
+        CircuitSAT& _circuit;
+        Aig _aig;
+        std::vector<AigLit> _gate_lits;
+        CdclSolver _solver;
+        AigEncoding _encoding;
+        std::unordered_map<std::string, GateIdx> _names;
+        bool _adjacency_stale = false;
+
+        ValueEnum _result = ValueEnum::NotDetermined;
+        std::vector<bool> _model;
+
+        size_t _merged_by_sweeping = 0;
+        size_t _queries = 0;
+};
@@ -0,0 +1,660 @@
+#include "Justification.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+constexpr double var_decay = 0.95;
+constexpr float clause_decay = 0.999f;
+constexpr uint64_t restart_unit = 100;   // conflicts in one unit of the Luby sequence
+
+} // namespace
+
+JustificationSolver::JustificationSolver(CircuitSAT const& obj)
+  : _circuit(obj) {
+    /** normalize local constraints of the gates **/
+    size_t gates_count = obj.get_gates_count();
+    _kinds.resize(gates_count, KindEnum::INPUT);
+    _invert_inputs.resize(gates_count, false);
+    _invert_outputs.resize(gates_count, false);
+    _parity_constants.resize(gates_count, 0);
+    _parity_offsets.push_back(0);
+
+    std::vector<GateIdx> operands;
+    for (GateIdx gate = 0; gate != gates_count; ++gate) {
+        OperatorsEnum op = obj.get_gate(gate).get_operator_type();
+        assert(op != OperatorsEnum::UNKNOWN && "Gate has no operator");
+
+        switch (op) {
+            case OperatorsEnum::AND:
+            case OperatorsEnum::NAND:
+            case OperatorsEnum::OR:
+            case OperatorsEnum::NOR:
+                // OR(a, b) = NOT(AND(NOT a, NOT b))
+                _kinds[gate] = KindEnum::AND;
+                _invert_inputs[gate] = op == OperatorsEnum::OR || op == OperatorsEnum::NOR;
+                _invert_outputs[gate] = op == OperatorsEnum::NAND || op == OperatorsEnum::OR;
+                break;
+
+            case OperatorsEnum::XOR:
+            case OperatorsEnum::NXOR:
+            case OperatorsEnum::NOT:
+            case OperatorsEnum::BUFF: {
+                _kinds[gate] = KindEnum::PARITY;
+                _parity_constants[gate] = op == OperatorsEnum::NXOR || op == OperatorsEnum::NOT;
+
+                GateRange gate_operands = obj.get_gate(gate).get_operand_indexes();
+                operands.assign(gate_operands.begin(), gate_operands.end());
+                std::sort(operands.begin(), operands.end());
+                size_t size = 0;
+                for (GateIdx operand : operands) {
+                    if (size != 0 && operands[size - 1] == operand) {
+                        --size; // x ^ x = 0
+                    } else {
+                        operands[size++] = operand;
+                    }
+                }
+                operands.resize(size);
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (_kinds[gate] != KindEnum::PARITY) {
+            operands.clear();
+        }
+        _parity_operands.insert(_parity_operands.end(), operands.begin(), operands.end());
+        _parity_offsets.push_back(_parity_operands.size());
+    }
+
+    _values.resize(gates_count, -1);
+    _levels.resize(gates_count, 0);
+    _reasons.resize(gates_count, {ReasonEnum::NONE, 0});
+    _trail_pos.resize(gates_count, 0);
+    _activity.resize(gates_count, 0.0);
+    _polarity.resize(gates_count, true);
+    _seen.resize(gates_count, 0);
+    _watches.resize(2 * gates_count);
+}
+
+void JustificationSolver::_enqueue(Lit lit, Reason reason) {
+    GateIdx gate = static_cast<GateIdx>(lit_var(lit));
+    _values[gate] = static_cast<int8_t>(!lit_sign(lit));
+    _levels[gate] = static_cast<uint32_t>(_decision_level());
+    _reasons[gate] = reason;
+    _trail_pos[gate] = _trail.size();
+    _trail.push_back(lit);
+    if (_kinds[gate] != KindEnum::INPUT) {
+        _frontier.push_back(gate);
+    }
+}
+
+void JustificationSolver::_cancel_until(size_t level) {
+    if (_decision_level() <= level) {
+        return;
+    }
+    for (size_t pos = _trail.size(); pos != _trail_lim[level]; --pos) {
+        GateIdx gate = static_cast<GateIdx>(lit_var(_trail[pos - 1]));
+        _values[gate] = -1;
+        _polarity[gate] = lit_sign(_trail[pos - 1]);
+    }
+    _trail.resize(_trail_lim[level]);
+    _trail_lim.resize(level);
+    _qhead = _trail.size();
+
+    // gates justified above the level may be unjustified again
+    while (!_frontier_log.empty() && _frontier_log.back().second > level) {
+        GateIdx gate = _frontier_log.back().first;
+        if (_values[gate] >= 0) {
+            _frontier.push_back(gate);
+        }
+        _frontier_log.pop_back();
+    }
+}
+
+bool JustificationSolver::_propagate_and(GateIdx gate) {
+    /** y = AND(l_1 .. l_n): any l_i = 0 => y = 0, all l_i = 1 => y = 1, y = 1 => all l_i = 1,
+     *  y = 0 and all l_i = 1 except one => that one is 0 **/
+    bool invert_inputs = _invert_inputs[gate];
+    Lit y = make_lit(static_cast<Var>(gate), _invert_outputs[gate]);
+    int8_t y_value = _lit_value(y);
+
+    size_t unassigned = 0;
+    Lit last_unassigned = lit_undef;
+    for (GateIdx operand : _circuit.get_gate(gate).get_operand_indexes()) {
+        Lit input = make_lit(static_cast<Var>(operand), invert_inputs);
+        int8_t input_value = _lit_value(input);
+
+        if (input_value == 0) {
+            if (y_value == 1) {
+                _conflict = {lit_neg(y), input};
+                return false;
+            }
+            if (y_value < 0) {
+                _enqueue(lit_neg(y), {ReasonEnum::GATE, static_cast<uint32_t>(gate)});
+            }
+            return true;
+        }
+        if (input_value < 0) {
+            ++unassigned;
+            last_unassigned = input;
+        }
+    }
+
+    if (unassigned == 0) {
+        if (y_value == 0) {
+            _conflict = {y};
+            for (GateIdx operand : _circuit.get_gate(gate).get_operand_indexes()) {
+                _conflict.push_back(lit_neg(make_lit(static_cast<Var>(operand), invert_inputs)));
+            }
+            return false;
+        }
+        if (y_value < 0) {
+            _enqueue(y, {ReasonEnum::GATE, static_cast<uint32_t>(gate)});
+        }
+    } else if (y_value == 1) {
+        for (GateIdx operand : _circuit.get_gate(gate).get_operand_indexes()) {
+            Lit input = make_lit(static_cast<Var>(operand), invert_inputs);
+            if (_lit_value(input) < 0) {
+                _enqueue(input, {ReasonEnum::GATE, static_cast<uint32_t>(gate)});
+            }
+        }
+    } else if (y_value == 0 && unassigned == 1) {
+        _enqueue(lit_neg(last_unassigned), {ReasonEnum::GATE, static_cast<uint32_t>(gate)});
+    }
+    return true;
+}
+
+bool JustificationSolver::_propagate_parity(GateIdx gate) {
+    /** gate ^ XOR(operands) = constant: the last unassigned variable is implied **/
+    size_t unassigned = 0;
+    GateIdx last_unassigned = gate;
+    uint8_t parity = _parity_constants[gate];
+
+    auto visit = [&](GateIdx var) {
+        if (_values[var] < 0) {
+            ++unassigned;
+            last_unassigned = var;
+        } else {
+            parity ^= static_cast<uint8_t>(_values[var]);
+        }
+    };
+    visit(gate);
+    for (size_t pos = _parity_offsets[gate]; pos != _parity_offsets[gate + 1]; ++pos) {
+        visit(_parity_operands[pos]);
+    }
+
+    if (unassigned == 0 && parity != 0) {
+        _conflict.clear();
+        _conflict.push_back(lit_neg(_current_lit(gate)));
+        for (size_t pos = _parity_offsets[gate]; pos != _parity_offsets[gate + 1]; ++pos) {
+            _conflict.push_back(lit_neg(_current_lit(_parity_operands[pos])));
+        }
+        return false;
+    }
+    if (unassigned == 1) {
+        _enqueue(make_lit(static_cast<Var>(last_unassigned), parity == 0), {ReasonEnum::GATE, static_cast<uint32_t>(gate)});
+    }
+    return true;
+}
+
+bool JustificationSolver::_propagate_gate(GateIdx gate) {
+    ++_propagations;
+    switch (_kinds[gate]) {
+        case KindEnum::AND:
+            return _propagate_and(gate);
+        case KindEnum::PARITY:
+            return _propagate_parity(gate);
+        default:
+            return true;
+    }
+}
+
+bool JustificationSolver::_propagate_clauses(Lit false_lit) {
+    /** two watched literals of the learned clauses **/
+    std::vector<Watcher>& watches = _watches[false_lit];
+    size_t keep = 0;
+    size_t pos = 0;
+    bool ok = true;
+
+    while (pos != watches.size()) {
+        Watcher watcher = watches[pos++];
+        Learnt& clause = _learnts[watcher.clause];
+        if (clause.deleted) {
+            continue;
+        }
+        if (_lit_value(watcher.blocker) == 1) {
+            watches[keep++] = watcher;
+            continue;
+        }
+
+        std::vector<Lit>& lits = clause.lits;
+        if (lits[0] == false_lit) {
+            std::swap(lits[0], lits[1]);
+        }
+        Watcher updated{watcher.clause, lits[0]};
+        if (_lit_value(lits[0]) == 1) {
+            watches[keep++] = updated;
+            continue;
+        }
+
+        bool moved = false;
+        for (size_t k = 2; k != lits.size(); ++k) {
+            if (_lit_value(lits[k]) != 0) {
+                std::swap(lits[1], lits[k]);
+                _watches[lits[1]].push_back(updated);
+                moved = true;
+                break;
+            }
+        }
+        if (moved) {
+            continue;
+        }
+
+        watches[keep++] = updated;
+        if (_lit_value(lits[0]) == 0) {
+            _conflict = lits;
+            ok = false;
+            while (pos != watches.size()) {
+                watches[keep++] = watches[pos++];
+            }
+        } else {
+            _enqueue(lits[0], {ReasonEnum::CLAUSE, watcher.clause});
+        }
+    }
+    watches.resize(keep);
+    return ok;
+}
+
+bool JustificationSolver::_propagate() {
+    /** every assigned gate wakes up its own constraint, constraints of its children and learned clauses **/
+    while (_qhead < _trail.size()) {
+        Lit lit = _trail[_qhead++];
+        GateIdx gate = static_cast<GateIdx>(lit_var(lit));
+
+        if (!_propagate_gate(gate)) {
+            return false;
+        }
+        for (GateIdx child : _circuit.get_gate(gate).get_children_indexes()) {
+            if (!_propagate_gate(child)) {
+                return false;
+            }
+        }
+        if (!_propagate_clauses(lit_neg(lit))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void JustificationSolver::_explain(GateIdx gate, std::vector<Lit>& lits) const {
+    /** clause of the reason: the implied literal first, then the False literals that implied it **/
+    Reason reason = _reasons[gate];
+    if (reason.kind == ReasonEnum::CLAUSE) {
+        lits = _learnts[reason.ref].lits;
+        return;
+    }
+
+    GateIdx source = reason.ref;
+    lits.assign(1, _current_lit(gate));
+
+    if (_kinds[source] == KindEnum::PARITY) {
+        if (source != gate) {
+            lits.push_back(lit_neg(_current_lit(source)));
+        }
+        for (size_t pos = _parity_offsets[source]; pos != _parity_offsets[source + 1]; ++pos) {
+            if (_parity_operands[pos] != gate) {
+                lits.push_back(lit_neg(_current_lit(_parity_operands[pos])));
+            }
+        }
+        return;
+    }
+
+    bool invert_inputs = _invert_inputs[source];
+    Lit y = make_lit(static_cast<Var>(source), _invert_outputs[source]);
+    GateRange operands = _circuit.get_gate(source).get_operand_indexes();
+
+    if (source == gate) {
+        if (_lit_value(y) == 1) { // all inputs are True
+            for (GateIdx operand : operands) {
+                lits.push_back(lit_neg(make_lit(static_cast<Var>(operand), invert_inputs)));
+            }
+        } else { // the earliest False input
+            for (GateIdx operand : operands) {
+                Lit input = make_lit(static_cast<Var>(operand), invert_inputs);
+                if (_lit_value(input) == 0 && _trail_pos[operand] < _trail_pos[gate]) {
+                    lits.push_back(input);
+                    break;
+                }
+            }
+        }
+        return;
+    }
+
+    if (_lit_value(make_lit(static_cast<Var>(gate), invert_inputs)) == 1) { // y = 1
+        lits.push_back(lit_neg(y));
+    } else { // y = 0 and all other inputs are True
+        lits.push_back(y);
+        for (GateIdx operand : operands) {
+            if (operand != gate) {
+                lits.push_back(lit_neg(make_lit(static_cast<Var>(operand), invert_inputs)));
+            }
+        }
+    }
+}
+
+void JustificationSolver::_bump_gate(GateIdx gate) {
+    if ((_activity[gate] += _var_inc) > 1e100) {
+        for (double& activity : _activity) {
+            activity *= 1e-100;
+        }
+        _var_inc *= 1e-100;
+    }
+}
+
+void JustificationSolver::_bump_clause(Learnt& clause) {
+    if ((clause.activity += _clause_inc) > 1e20f) {
+        for (Learnt& learnt : _learnts) {
+            learnt.activity *= 1e-20f;
+        }
+        _clause_inc *= 1e-20f;
+    }
+}
+
+bool JustificationSolver::_literal_redundant(Lit lit) {
+    GateIdx gate = static_cast<GateIdx>(lit_var(lit));
+    if (_reasons[gate].kind == ReasonEnum::NONE) {
+        return false;
+    }
+    std::vector<Lit> reason;
+    _explain(gate, reason);
+    for (size_t k = 1; k != reason.size(); ++k) {
+        GateIdx var = static_cast<GateIdx>(lit_var(reason[k]));
+        if (!_seen[var] && _levels[var] > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void JustificationSolver::_analyze(std::vector<Lit>& learnt, size_t& backtrack_level, uint32_t& lbd) {
+    /** first unique implication point over gate literals, starts from _conflict **/
+    learnt.assign(1, lit_undef);
+    std::vector<Lit> lits = _conflict;
+    size_t path_count = 0;
+    Lit lit = lit_undef;
+    size_t index = _trail.size();
+
+    while (true) {
+        if (lit != lit_undef && _reasons[lit_var(lit)].kind == ReasonEnum::CLAUSE) {
+            _bump_clause(_learnts[_reasons[lit_var(lit)].ref]);
+        }
+        for (size_t k = (lit == lit_undef ? 0 : 1); k != lits.size(); ++k) {
+            GateIdx var = static_cast<GateIdx>(lit_var(lits[k]));
+            if (!_seen[var] && _levels[var] > 0) {
+                _bump_gate(var);
+                _seen[var] = 1;
+                if (_levels[var] >= _decision_level()) {
+                    ++path_count;
+                } else {
+                    learnt.push_back(lits[k]);
+                }
+            }
+        }
+
+        while (!_seen[lit_var(_trail[--index])]) {}
+        lit = _trail[index];
+        _seen[lit_var(lit)] = 0;
+        if (--path_count == 0) {
+            break;
+        }
+        _explain(static_cast<GateIdx>(lit_var(lit)), lits);
+    }
+    learnt[0] = lit_neg(lit);
+
+    std::vector<Lit> analyzed(learnt.begin() + 1, learnt.end());
+    size_t size = 1;
+    for (size_t pos = 1; pos != learnt.size(); ++pos) {
+        if (!_literal_redundant(learnt[pos])) {
+            learnt[size++] = learnt[pos];
+        }
+    }
+    learnt.resize(size);
+    for (Lit analyzed_lit : analyzed) {
+        _seen[lit_var(analyzed_lit)] = 0;
+    }
+
+    backtrack_level = 0;
+    if (learnt.size() > 1) {
+        size_t max_pos = 1;
+        for (size_t pos = 2; pos != learnt.size(); ++pos) {
+            if (_levels[lit_var(learnt[pos])] > _levels[lit_var(learnt[max_pos])]) {
+                max_pos = pos;
+            }
+        }
+        std::swap(learnt[1], learnt[max_pos]);
+        backtrack_level = _levels[lit_var(learnt[1])];
+    }
+
+    std::vector<uint32_t> levels;
+    for (Lit learnt_lit : learnt) {
+        levels.push_back(_levels[lit_var(learnt_lit)]);
+    }
+    std::sort(levels.begin(), levels.end());
+    lbd = static_cast<uint32_t>(std::unique(levels.begin(), levels.end()) - levels.begin());
+}
+
+bool JustificationSolver::_is_justified(GateIdx gate) const {
+    /** the value of the gate already follows from the values of its operands **/
+    if (_kinds[gate] == KindEnum::PARITY) {
+        for (size_t pos = _parity_offsets[gate]; pos != _parity_offsets[gate + 1]; ++pos) {
+            if (_values[_parity_operands[pos]] < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (_lit_value(make_lit(static_cast<Var>(gate), _invert_outputs[gate])) == 1) {
+        return true; // y = 1 assigns all inputs by propagation
+    }
+    for (GateIdx operand : _circuit.get_gate(gate).get_operand_indexes()) {
+        if (_lit_value(make_lit(static_cast<Var>(operand), _invert_inputs[gate])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Lit JustificationSolver::_pick_decision() {
+    /** justify the latest unjustified gate by its most active unassigned operand **/
+    while (!_frontier.empty()) {
+        GateIdx gate = _frontier.back();
+        if (_values[gate] < 0) {
+            _frontier.pop_back();
+            continue;
+        }
+        if (_is_justified(gate)) {
+            _frontier.pop_back();
+            _frontier_log.emplace_back(gate, _decision_level());
+            continue;
+        }
+
+        GateIdx best = gate;
+        auto choose = [&](GateIdx operand) {
+            if (_values[operand] < 0 && (best == gate || _activity[operand] > _activity[best])) {
+                best = operand;
+            }
+        };
+        if (_kinds[gate] == KindEnum::PARITY) {
+            for (size_t pos = _parity_offsets[gate]; pos != _parity_offsets[gate + 1]; ++pos) {
+                choose(_parity_operands[pos]);
+            }
+            return make_lit(static_cast<Var>(best), _polarity[best]);
+        }
+        for (GateIdx operand : _circuit.get_gate(gate).get_operand_indexes()) {
+            choose(operand);
+        }
+        assert(best != gate && "Unjustified gate without unassigned operands");
+        return make_lit(static_cast<Var>(best), !_invert_inputs[gate]); // the operand makes y = 0
+    }
+    return lit_undef;
+}
+
+void JustificationSolver::_add_learnt(std::vector<Lit> const& lits, uint32_t lbd) {
+    uint32_t index = static_cast<uint32_t>(_learnts.size());
+    _learnts.push_back({lits, lbd, 0.0f, false});
+    _bump_clause(_learnts.back());
+    _watches[lits[0]].push_back({index, lits[1]});
+    _watches[lits[1]].push_back({index, lits[0]});
+    _enqueue(lits[0], {ReasonEnum::CLAUSE, index});
+}
+
+void JustificationSolver::_reduce_db() {
+    /** remove the less useful half of learned clauses, glue clauses (LBD <= 2) and reasons are kept **/
+    std::vector<uint32_t> order(_learnts.size());
+    for (uint32_t pos = 0; pos != order.size(); ++pos) {
+        order[pos] = pos;
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) {
+        if (_learnts[lhs].lbd != _learnts[rhs].lbd) {
+            return _learnts[lhs].lbd > _learnts[rhs].lbd;
+        }
+        return _learnts[lhs].activity < _learnts[rhs].activity;
+    });
+
+    for (size_t pos = 0; pos != order.size() / 2; ++pos) {
+        Learnt& clause = _learnts[order[pos]];
+        GateIdx first = static_cast<GateIdx>(lit_var(clause.lits[0]));
+        bool locked = _values[first] >= 0 && _reasons[first].kind == ReasonEnum::CLAUSE
+                      && _reasons[first].ref == order[pos];
+        if (!locked && clause.lbd > 2) {
+            clause.deleted = true;
+        }
+    }
+
+    // compact the clauses, remap reasons and watches
+    std::vector<uint32_t> new_index(_learnts.size(), UINT32_MAX);
+    size_t keep = 0;
+    for (size_t pos = 0; pos != _learnts.size(); ++pos) {
+        if (!_learnts[pos].deleted) {
+            new_index[pos] = static_cast<uint32_t>(keep);
+            if (keep != pos) { // a self-move would leave the clause empty
+                _learnts[keep] = std::move(_learnts[pos]);
+            }
+            ++keep;
+        }
+    }
+    _learnts.resize(keep);
+
+    for (Lit lit : _trail) {
+        Reason& reason = _reasons[lit_var(lit)];
+        if (reason.kind == ReasonEnum::CLAUSE) {
+            reason.ref = new_index[reason.ref];
+        }
+    }
+    for (std::vector<Watcher>& watches : _watches) {
+        watches.clear();
+    }
+    for (uint32_t index = 0; index != _learnts.size(); ++index) {
+        _watches[_learnts[index].lits[0]].push_back({index, _learnts[index].lits[1]});
+        _watches[_learnts[index].lits[1]].push_back({index, _learnts[index].lits[0]});
+    }
+}
+
+void JustificationSolver::_publish_stats() {
+    if (_stats == nullptr) {
+        return;
+    }
+    _stats->decisions.fetch_add(_decisions - _published_decisions, std::memory_order_relaxed);
+    _stats->conflicts.fetch_add(_conflicts - _published_conflicts, std::memory_order_relaxed);
+    _stats->propagations.fetch_add(_propagations - _published_propagations, std::memory_order_relaxed);
+    _published_decisions = _decisions;
+    _published_conflicts = _conflicts;
+    _published_propagations = _propagations;
+}
+
+ValueEnum JustificationSolver::solve(GateIdx objective) {
+    ValueEnum result = _search(objective);
+    _publish_stats();
+    return result;
+}
+
+ValueEnum JustificationSolver::_search(GateIdx objective) {
+    if (!_ok) {
+        return ValueEnum::False;
+    }
+    _cancel_until(0);
+
+    Lit goal = make_lit(static_cast<Var>(objective));
+    if (_lit_value(goal) == 0) {
+        return ValueEnum::False;
+    }
+    if (_lit_value(goal) < 0) {
+        _enqueue(goal, {ReasonEnum::NONE, 0});
+    }
+    for (GateIdx gate = 0; gate != _kinds.size(); ++gate) { // constant parity gates: x = c
+        if (_kinds[gate] == KindEnum::PARITY && _parity_offsets[gate] == _parity_offsets[gate + 1]
+                && _values[gate] < 0) {
+            _enqueue(make_lit(static_cast<Var>(gate), _parity_constants[gate] == 0), {ReasonEnum::GATE,
+                                                                            static_cast<uint32_t>(gate)});
+        }
+    }
+
+    std::vector<Lit> learnt;
+    uint64_t conflicts_to_restart = static_cast<uint64_t>(luby(2, _restarts) * restart_unit);
+    uint64_t conflicts_since_restart = 0;
+
+    while (true) {
+        if (!_propagate()) {
+            ++_conflicts;
+            ++conflicts_since_restart;
+            if (_decision_level() == 0) {
+                _ok = false;
+                return ValueEnum::False;
+            }
+            if (_stop != nullptr && _stop->load(std::memory_order_relaxed)) {
+                _cancel_until(0);
+                return ValueEnum::NotDetermined;
+            }
+
+            size_t backtrack_level;
+            uint32_t lbd;
+            _analyze(learnt, backtrack_level, lbd);
+            _cancel_until(backtrack_level);
+
+            if (learnt.size() == 1) {
+                _enqueue(learnt[0], {ReasonEnum::NONE, 0});
+            } else {
+                _add_learnt(learnt, lbd);
+            }
+            _var_inc /= var_decay;
+            _clause_inc /= clause_decay;
+            continue;
+        }
+
+        if (conflicts_since_restart >= conflicts_to_restart) {
+            _cancel_until(0);
+            ++_restarts;
+            conflicts_since_restart = 0;
+            conflicts_to_restart = static_cast<uint64_t>(luby(2, _restarts) * restart_unit);
+            _publish_stats();
+        }
+        if (_learnts.size() >= _max_learnts + _trail.size()) {
+            _reduce_db();
+            _max_learnts += _max_learnts / 10;
+        }
+
+        Lit decision = _pick_decision();
+        if (decision == lit_undef) { // every assigned gate is justified
+            _model = _values;
+            return ValueEnum::True;
+        }
+
+        ++_decisions;
+        _trail_lim.push_back(_trail.size());
+        _enqueue(decision, {ReasonEnum::NONE, 0});
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Circuit.h"
+#include "Cdcl.h"
+#include "Stats.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class JustificationSolver {
+    /**
+     * Clause learning directly on the gate graph: literals are gate values (make_lit(gate, value == False)),
+     * implications go forward and backward through the local constraint of every gate using the operand and
+     * children adjacency of CircuitSAT, decisions are taken only to justify gates from the J-frontier.
+     * Conflicts are analysed to the first unique implication point and learned as clauses over gate values.
+     *
+     * @private_fields:
+     *      _kinds              -- local constraint of the gate: input, AND-like or parity
+     *      _invert_inputs      -- AND-like gates are y = AND(operand ^ invert_inputs), gate = y ^ invert_output
+     *      _invert_outputs
+     *      _parity_offsets     -- parity gates (XOR/NXOR/NOT/BUFF) are gate ^ XOR(operands) = _parity_constants,
+     *      _parity_operands       operands occurring an even number of times are cancelled
+     *      _parity_constants
+     *      _values             -- value of every gate (-1 -- not assigned, 0 -- False, 1 -- True)
+     *      _levels, _reasons   -- decision level of the gate and the constraint that implied it
+     *      _trail, _trail_lim  -- assigned literals in order and the trail size at the start of every level
+     *      _frontier           -- stack of assigned gates that may be unjustified
+     *      _frontier_log       -- gates removed from the frontier as justified and the level they were removed at,
+     *                             they come back when the search backtracks below that level
+     *      _learnts, _watches  -- learned clauses and their two watched literals
+     *
+     * @methods:
+     *      solve               -- True if the objective gate can be True, False otherwise,
+     *                             NotDetermined if the search was stopped from outside
+     *      set_stop            -- flag checked on every conflict, solve gives up when it is set
+     *      set_stats           -- decisions, conflicts and propagations are added to stats on every restart
+     *                             and at the end of solve
+     *      model_value         -- value of the gate in the found model, not assigned gates are False
+     **/
+
+    public:
+        explicit JustificationSolver(CircuitSAT const& obj);
+
+        ValueEnum solve(GateIdx objective);
+        void set_stop(std::atomic<bool> const* stop)     {_stop = stop;}
+        void set_stats(Stats* stats)                     {_stats = stats;}
+        [[nodiscard]] ValueEnum model_value(GateIdx gate) const {
+            return _model.at(gate) == 1 ? ValueEnum::True : ValueEnum::False;
+        }
+
+        [[nodiscard]] uint64_t get_decisions()           const {return _decisions;}
+        [[nodiscard]] uint64_t get_conflicts()           const {return _conflicts;}
+        [[nodiscard]] uint64_t get_propagations()        const {return _propagations;}
+        [[nodiscard]] uint64_t get_restarts()            const {return _restarts;}
+
+    private:
+        enum class KindEnum : uint8_t {INPUT, AND, PARITY};
+        enum class ReasonEnum : uint8_t {NONE, GATE, CLAUSE};
+
+        struct Reason {
+            ReasonEnum kind;
+            uint32_t ref;
+        };
+
+        struct Learnt {
+            std::vector<Lit> lits;
+            uint32_t lbd;
+            float activity;
+            bool deleted;
+        };
+
+        struct Watcher {
+            uint32_t clause;
+            Lit blocker;
+        };
+
+        // assignment
+        int8_t _lit_value(Lit lit) const {
+            int8_t value = _values[lit_var(lit)];
+            return value < 0 ? value : static_cast<int8_t>(value ^ static_cast<int8_t>(lit_sign(lit)));
+        }
+        Lit _current_lit(GateIdx gate) const {return make_lit(static_cast<Var>(gate), _values[gate] == 0);}
+        size_t _decision_level() const {return _trail_lim.size();}
+        void _enqueue(Lit lit, Reason reason);
+        void _cancel_until(size_t level);
+        ValueEnum _search(GateIdx objective);
+        void _publish_stats();
+
+        // propagation through gates and learned clauses
+        bool _propagate();
+        bool _propagate_gate(GateIdx gate);
+        bool _propagate_and(GateIdx gate);
+        bool _propagate_parity(GateIdx gate);
+        bool _propagate_clauses(Lit false_lit);
+        void _explain(GateIdx gate, std::vector<Lit>& lits) const;
+
+        // conflict analysis
+        void _analyze(std::vector<Lit>& learnt, size_t& backtrack_level, uint32_t& lbd);
+        bool _literal_redundant(Lit lit);
+        void _bump_gate(GateIdx gate);
+        void _bump_clause(Learnt& clause);
+
+        // justification frontier
+        bool _is_justified(GateIdx gate) const;
+        Lit _pick_decision();
+
+        // clause database
+        void _add_learnt(std::vector<Lit> const& lits, uint32_t lbd);
+        void _reduce_db();
+
+        CircuitSAT const& _circuit;
+
+        std::vector<KindEnum> _kinds;
+        std::vector<bool> _invert_inputs;
+        std::vector<bool> _invert_outputs;
+        std::vector<size_t> _parity_offsets;
+        std::vector<GateIdx> _parity_operands;
+        std::vector<uint8_t> _parity_constants;
+
+        std::vector<int8_t> _values;
+        std::vector<uint32_t> _levels;
+        std::vector<Reason> _reasons;
+        std::vector<size_t> _trail_pos;
+        std::vector<Lit> _trail;
+        std::vector<size_t> _trail_lim;
+        size_t _qhead = 0;
+
+        std::vector<GateIdx> _frontier;
+        std::vector<std::pair<GateIdx, size_t>> _frontier_log;
+
+        std::vector<Learnt> _learnts;
+        std::vector<std::vector<Watcher>> _watches;
+        size_t _max_learnts = 2000;
+
+        std::vector<double> _activity;
+        std::vector<bool> _polarity;
+        double _var_inc = 1.0;
+        float _clause_inc = 1.0f;
+
+        std::vector<Lit> _conflict;
+        std::vector<uint8_t> _seen;
+        std::vector<int8_t> _model;
+        bool _ok = true;
+        std::atomic<bool> const* _stop = nullptr;
+
+        uint64_t _decisions = 0;
+        uint64_t _conflicts = 0;
+        uint64_t _propagations = 0;
+        uint64_t _restarts = 0;
+        Stats* _stats = nullptr;
+        uint64_t _published_decisions = 0;
+        uint64_t _published_conflicts = 0;
+        uint64_t _published_propagations = 0;
+};
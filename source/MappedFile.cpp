@@ -0,0 +1,34 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(std::string const& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) == 0) {
+        _size = static_cast<size_t>(file_stat.st_size);
+        if (_size == 0) {
+            _is_open = true;
+        } else {
+            void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                madvise(data, _size, MADV_SEQUENTIAL);
+                _data = data;
+                _is_open = true;
+            }
+        }
+    }
+    close(fd); // the mapping stays valid after the descriptor is closed
+}
+
+MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+        munmap(_data, _size);
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+    /**
+     * Read-only memory mapping of a whole file, unmapped in the destructor
+     * @private_fields:
+     *      _data               -- first byte of the mapping (nullptr for an empty file)
+     *      _size               -- file size in bytes
+     *      _is_open            -- the file was opened and mapped
+     **/
+
+    public:
+        explicit MappedFile(std::string const& path);
+        ~MappedFile();
+
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator=(MappedFile const&) = delete;
+
+        [[nodiscard]] bool is_open()             const {return _is_open;}
+        [[nodiscard]] char const* data()         const {return static_cast<char const*>(_data);}
+        [[nodiscard]] size_t size()              const {return _size;}
+        [[nodiscard]] std::string_view view()    const {return {data(), _size};}
+
+    private:
+        void* _data = nullptr;
+        size_t _size = 0;
+        bool _is_open = false;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Circuit.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+class NameIndex {
+    /**
+     * Open-addressing hash table (linear probing) from gate names to gate indexes.
+     * The table stores only [hash, index] pairs, names are compared with the names interned in the circuit,
+     * so lookups by string_view need no allocation.
+     * @private_fields:
+     *      _hashes             -- full hash of the name in the slot, 0 marks an empty slot
+     *      _indexes            -- gate index in the slot
+     *      _size               -- occupied slots
+     **/
+
+    public:
+        explicit NameIndex(size_t expected = 0) {_resize(expected < 8 ? 16 : _round_up(2 * expected));}
+
+        static uint64_t hash(std::string_view name) { /** FNV-1a, 0 is reserved for empty slots **/
+            uint64_t value = 14695981039346656037ull;
+            for (char ch : name) {
+                value = (value ^ static_cast<uint8_t>(ch)) * 1099511628211ull;
+            }
+            return value == 0 ? 1 : value;
+        }
+
+        [[nodiscard]] GateIdx find(std::string_view name, uint64_t name_hash, CircuitSAT const& obj) const {
+            /** gate index or not_found **/
+            size_t mask = _hashes.size() - 1;
+            for (size_t slot = name_hash & mask; _hashes[slot] != 0; slot = (slot + 1) & mask) {
+                if (_hashes[slot] == name_hash && obj.get_gate(_indexes[slot]).get_name() == name) {
+                    return _indexes[slot];
+                }
+            }
+            return not_found;
+        }
+
+        void insert(uint64_t name_hash, GateIdx index) {
+            if (2 * (_size + 1) > _hashes.size()) {
+                _resize(2 * _hashes.size());
+            }
+            _place(name_hash, index);
+            ++_size;
+        }
+
+        static constexpr GateIdx not_found = UINT32_MAX;
+
+    private:
+        static size_t _round_up(size_t value) {
+            size_t power = 1;
+            while (power < value) {
+                power *= 2;
+            }
+            return power;
+        }
+
+        void _place(uint64_t name_hash, GateIdx index) {
+            size_t mask = _hashes.size() - 1;
+            size_t slot = name_hash & mask;
+            while (_hashes[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            _hashes[slot] = name_hash;
+            _indexes[slot] = index;
+        }
+
+        void _resize(size_t capacity) {
+            std::vector<uint64_t> hashes = std::move(_hashes);
+            VecGates indexes = std::move(_indexes);
+            _hashes.assign(capacity, 0);
+            _indexes.assign(capacity, 0);
+            for (size_t slot = 0; slot != hashes.size(); ++slot) {
+                if (hashes[slot] != 0) {
+                    _place(hashes[slot], indexes[slot]);
+                }
+            }
+        }
+
+        std::vector<uint64_t> _hashes;
+        VecGates _indexes;
+        size_t _size = 0;
+};
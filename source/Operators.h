@@ -1,19 +1,70 @@
 #pragma once
 
 #include "Circuit.h"
+#include <cassert>
 
 struct Operators {
-    /** Struct with the implementation of operator functions for getting the value of the gate **/
+    /**
+     * Evaluation kernels of the gate operators on raw buffers: operands is the packed array of operand indexes
+     * of the gate (a slice of CircuitSAT::_operand_edges), values is the value buffer of the circuit where every
+     * operand is True or False. evaluate dispatches by a switch (compiled to a jump table) to the kernel
+     * specialized for the operator; NOT/BUFF and two-operand gates don't enter the loop over the operands.
+     * XOR over more than two operands is their parity, as in the bit-parallel simulation
+     **/
     public:
-        static bool gate_AND(VecGates const& operands, CircuitSAT& obj);
-        static bool gate_OR(VecGates const& operands, CircuitSAT& obj);
-        static bool gate_NOT(VecGates const& operands, CircuitSAT& obj);
-        static bool gate_XOR(VecGates const& operands, CircuitSAT& obj);
-        static bool gate_NAND(VecGates const& operands, CircuitSAT& obj);
-        static bool gate_NOR(VecGates const& operands, CircuitSAT& obj);
-        static bool gate_NXOR(VecGates const& operands, CircuitSAT& obj);
-        static bool gate_BUFF(VecGates const& operands, CircuitSAT& obj);
+        template <OperatorsEnum op>
+        static bool gate(GateIdx const* operands, size_t count, ValueEnum const* values);
+        static bool evaluate(OperatorsEnum op, GateIdx const* operands, size_t count, ValueEnum const* values);
 
     private:
         Operators() = default;
+
+        static bool _is_true(ValueEnum value) {return value == ValueEnum::True;}
 };
+
+template <OperatorsEnum op>
+inline bool Operators::gate(GateIdx const* operands, size_t count, ValueEnum const* values) {
+    static_assert(op == OperatorsEnum::AND || op == OperatorsEnum::OR || op == OperatorsEnum::XOR,
+                  "Kernels are specialized for the operators without negation");
+    if (count == 2) {
+        bool lhs = _is_true(values[operands[0]]);
+        bool rhs = _is_true(values[operands[1]]);
+        return op == OperatorsEnum::AND ? lhs & rhs : op == OperatorsEnum::OR ? lhs | rhs : lhs != rhs;
+    }
+    bool res = op == OperatorsEnum::AND;
+    for (size_t pos = 0; pos != count; ++pos) {
+        bool value = _is_true(values[operands[pos]]);
+        if constexpr (op == OperatorsEnum::AND) {
+            res &= value;
+        } else if constexpr (op == OperatorsEnum::OR) {
+            res |= value;
+        } else {
+            res ^= value;
+        }
+    }
+    return res;
+}
+
+inline bool Operators::evaluate(OperatorsEnum op, GateIdx const* operands, size_t count, ValueEnum const* values) {
+    switch (op) {
+        case OperatorsEnum::BUFF:
+            return _is_true(values[operands[0]]);
+        case OperatorsEnum::NOT:
+            return !_is_true(values[operands[0]]);
+        case OperatorsEnum::AND:
+            return gate<OperatorsEnum::AND>(operands, count, values);
+        case OperatorsEnum::NAND:
+            return !gate<OperatorsEnum::AND>(operands, count, values);
+        case OperatorsEnum::OR:
+            return gate<OperatorsEnum::OR>(operands, count, values);
+        case OperatorsEnum::NOR:
+            return !gate<OperatorsEnum::OR>(operands, count, values);
+        case OperatorsEnum::XOR:
+            return gate<OperatorsEnum::XOR>(operands, count, values);
+        case OperatorsEnum::NXOR:
+            return !gate<OperatorsEnum::XOR>(operands, count, values);
+        default:
+            assert(false && "INPUT and UNKNOWN gates aren't evaluated");
+            return false;
+    }
+}
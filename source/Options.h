@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Circuit.h"
+#include <cstddef>
+#include <map>
+#include <string>
+
+using EngineMap = std::map<std::string, EngineEnum>;
+inline bool str_to_enum_engine(std::string const& str, EngineEnum& engine) {
+    static EngineMap str_to_enum { /** encode engine name from the command line to enum **/
+            {"recursive",  EngineEnum::RECURSIVE},
+            {"simulation", EngineEnum::SIMULATION},
+            {"cdcl",       EngineEnum::CDCL},
+            {"circuit",    EngineEnum::CIRCUIT},
+            {"cube",       EngineEnum::CUBE}
+    };
+
+    auto it = str_to_enum.find(str);
+    if (it == str_to_enum.end()) {
+        return false;
+    }
+    engine = it->second;
+    return true;
+}
+
+using OutputsMap = std::map<std::string, OutputsEnum>;
+inline bool str_to_enum_outputs(std::string const& str, OutputsEnum& mode) {
+    static OutputsMap str_to_enum { /** encode outputs mode from the command line to enum **/
+            {"any",  OutputsEnum::ANY},
+            {"each", OutputsEnum::EACH},
+            {"all",  OutputsEnum::ALL}
+    };
+
+    auto it = str_to_enum.find(str);
+    if (it == str_to_enum.end()) {
+        return false;
+    }
+    mode = it->second;
+    return true;
+}
+
+inline bool str_to_count(std::string const& str, size_t& count) {
+    /** non-negative decimal number from the command line **/
+    if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    count = std::stoul(str);
+    return true;
+}
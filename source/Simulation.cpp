@@ -0,0 +1,475 @@
+#include "Simulation.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cassert>
+#include <mutex>
+
+namespace {
+
+constexpr Word lane_patterns[6] = { /** value of the input i < 6 in lane b is the bit i of b **/
+        0xAAAAAAAAAAAAAAAAull,
+        0xCCCCCCCCCCCCCCCCull,
+        0xF0F0F0F0F0F0F0F0ull,
+        0xFF00FF00FF00FF00ull,
+        0xFFFF0000FFFF0000ull,
+        0xFFFFFFFF00000000ull
+};
+
+constexpr uint64_t stats_blocks = 1024; // blocks simulated by a task between the additions to Stats
+
+constexpr size_t log2_width(size_t W) {
+    return W <= 1 ? 0 : 1 + log2_width(W / 2);
+}
+
+template <size_t W>
+[[gnu::always_inline]] inline void evaluate(SimProgram const& prog, size_t first_gate_slot, Word* values) {
+    /** one topological pass over the gate slots, W words per slot **/
+    size_t const* operands = prog.operand_slots.data();
+
+    for (size_t slot = first_gate_slot; slot != prog.operators.size(); ++slot) {
+        size_t begin = prog.operand_offsets[slot];
+        size_t end = prog.operand_offsets[slot + 1];
+        Word* res = values + slot * W;
+        Word const* first = values + operands[begin] * W;
+
+        for (size_t w = 0; w != W; ++w) {
+            res[w] = first[w];
+        }
+
+        switch (prog.operators[slot]) {
+            case OperatorsEnum::AND:
+            case OperatorsEnum::NAND:
+                for (size_t pos = begin + 1; pos != end; ++pos) {
+                    Word const* other = values + operands[pos] * W;
+                    for (size_t w = 0; w != W; ++w) {
+                        res[w] &= other[w];
+                    }
+                }
+                break;
+            case OperatorsEnum::OR:
+            case OperatorsEnum::NOR:
+                for (size_t pos = begin + 1; pos != end; ++pos) {
+                    Word const* other = values + operands[pos] * W;
+                    for (size_t w = 0; w != W; ++w) {
+                        res[w] |= other[w];
+                    }
+                }
+                break;
+            case OperatorsEnum::XOR:
+            case OperatorsEnum::NXOR:
+                for (size_t pos = begin + 1; pos != end; ++pos) {
+                    Word const* other = values + operands[pos] * W;
+                    for (size_t w = 0; w != W; ++w) {
+                        res[w] ^= other[w];
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+
+        switch (prog.operators[slot]) {
+            case OperatorsEnum::NAND:
+            case OperatorsEnum::NOR:
+            case OperatorsEnum::NXOR:
+            case OperatorsEnum::NOT:
+                for (size_t w = 0; w != W; ++w) {
+                    res[w] = ~res[w];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+template <size_t W>
+[[gnu::always_inline]] inline size_t fill_low_inputs(SimProgram const& prog, std::vector<Word>& values) {
+    /** the lowest inputs get fixed patterns across the W * 64 lanes, returns the number of such inputs **/
+    constexpr size_t lane_bits = 6 + log2_width(W);
+    size_t inputs_count = prog.input_positions.size();
+    size_t low_inputs = inputs_count < lane_bits ? inputs_count : lane_bits;
+
+    values.resize(prog.operators.size() * W);
+    for (size_t input = 0; input != low_inputs; ++input) {
+        for (size_t w = 0; w != W; ++w) {
+            values[input * W + w] = input < 6 ? lane_patterns[input] : ((w >> (input - 6)) & 1 ? ~Word(0) : 0);
+        }
+    }
+    return low_inputs;
+}
+
+template <size_t W>
+[[gnu::always_inline]] inline void fill_high_inputs(size_t low_inputs, size_t high_inputs, uint64_t block,
+                                                    std::vector<Word>& values) {
+    /** the remaining inputs take the bits of the block counter **/
+    for (size_t high = 0; high != high_inputs; ++high) {
+        Word fill = (high < word_bits && ((block >> high) & 1)) ? ~Word(0) : 0;
+        for (size_t w = 0; w != W; ++w) {
+            values[(low_inputs + high) * W + w] = fill;
+        }
+    }
+}
+
+struct BlockCounter {
+    /** blocks simulated by one task, added to stats every stats_blocks blocks and when the task ends **/
+    Stats* stats;
+    uint64_t lanes;     // distinct assignments of one block
+    uint64_t gates;     // gate slots evaluated per block
+    uint64_t blocks = 0;
+
+    void add() {
+        if (++blocks == stats_blocks) {
+            flush();
+        }
+    }
+    void flush() {
+        if (stats != nullptr && blocks != 0) {
+            stats->add_evaluations(blocks * lanes, blocks * gates);
+        }
+        blocks = 0;
+    }
+    ~BlockCounter() {flush();}
+};
+
+struct SearchShared {
+    /**
+     * state shared by all tasks of one search, the first task that finds an assignment stops the others,
+     * stop is set from outside the search (nullptr -- never)
+     **/
+    std::atomic<bool> found{false};
+    std::atomic<bool> const* stop = nullptr;
+    Stats* stats = nullptr;
+    std::mutex mutex;
+    std::vector<bool> lanes_assignment;
+};
+
+constexpr size_t lane_bits_of(SimdLevelEnum level) {
+    return level == SimdLevelEnum::AVX512 ? 9 : (level == SimdLevelEnum::AVX2 ? 8 : 6);
+}
+
+template <size_t W>
+[[gnu::always_inline]] inline void search_blocks(SimProgram const& prog, uint64_t first_block, uint64_t last_block,
+                                                 std::vector<Word>& values, SearchShared& shared) {
+    /**
+     * the lowest inputs get fixed patterns across the W * 64 lanes, the remaining inputs take
+     * the bits of the block counter. If there are fewer inputs than lane bits, the extra lanes repeat
+     * the same assignments, so every set lane of the output is a valid satisfying assignment.
+     * values is the buffer of the calling thread, the circuit itself is never written
+     **/
+    size_t inputs_count = prog.input_positions.size();
+    size_t low_inputs = fill_low_inputs<W>(prog, values);
+    size_t high_inputs = inputs_count - low_inputs;
+    BlockCounter counter{shared.stats, uint64_t(1) << low_inputs, prog.operators.size() - inputs_count};
+
+    for (uint64_t block = first_block; block != last_block; ++block) {
+        if (shared.found.load(std::memory_order_relaxed)
+                || (shared.stop != nullptr && shared.stop->load(std::memory_order_relaxed))) {
+            return;
+        }
+        fill_high_inputs<W>(low_inputs, high_inputs, block, values);
+        evaluate<W>(prog, inputs_count, values.data());
+        counter.add();
+
+        Word const* output = values.data() + prog.output_slot * W;
+        for (size_t w = 0; w != W; ++w) {
+            if (output[w] != 0) {
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                if (shared.found.exchange(true)) {
+                    return;
+                }
+                size_t lane = w * word_bits + static_cast<size_t>(__builtin_ctzll(output[w]));
+                shared.lanes_assignment.assign(inputs_count, false);
+                for (size_t input = 0; input != low_inputs; ++input) {
+                    shared.lanes_assignment[input] = (lane >> input) & 1;
+                }
+                for (size_t high = 0; high != high_inputs; ++high) {
+                    shared.lanes_assignment[low_inputs + high] = high < word_bits && ((block >> high) & 1);
+                }
+                return;
+            }
+        }
+    }
+}
+
+using SearchKernel = void(*)(SimProgram const&, uint64_t, uint64_t, std::vector<Word>&, SearchShared&);
+
+void search_scalar(SimProgram const& prog, uint64_t first_block, uint64_t last_block,
+                   std::vector<Word>& values, SearchShared& shared) {
+    search_blocks<1>(prog, first_block, last_block, values, shared);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void search_avx2(SimProgram const& prog, uint64_t first_block, uint64_t last_block,
+                 std::vector<Word>& values, SearchShared& shared) {
+    search_blocks<4>(prog, first_block, last_block, values, shared);
+}
+
+__attribute__((target("avx512f")))
+void search_avx512(SimProgram const& prog, uint64_t first_block, uint64_t last_block,
+                   std::vector<Word>& values, SearchShared& shared) {
+    search_blocks<8>(prog, first_block, last_block, values, shared);
+}
+#endif
+
+SearchKernel select_kernel(SimdLevelEnum level) {
+    switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+        case SimdLevelEnum::AVX512:
+            return &search_avx512;
+        case SimdLevelEnum::AVX2:
+            return &search_avx2;
+#endif
+        default:
+            return &search_scalar;
+    }
+}
+
+struct CountShared {
+    /** sum of the models found by all tasks of one count, the tasks give up when stop is set **/
+    std::atomic<bool> const* stop = nullptr;
+    std::atomic<bool> stopped{false};
+    Stats* stats = nullptr;
+    std::mutex mutex;
+    BigCount total;
+};
+
+template <size_t W>
+[[gnu::always_inline]] inline void count_blocks(SimProgram const& prog, uint64_t first_block, uint64_t last_block,
+                                                std::vector<Word>& values, CountShared& shared) {
+    /**
+     * popcount of the output words over the blocks. If there are fewer inputs than lane bits, the extra lanes
+     * repeat the same assignments and are masked out, so every assignment is counted once
+     **/
+    size_t inputs_count = prog.input_positions.size();
+    size_t low_inputs = fill_low_inputs<W>(prog, values);
+    size_t high_inputs = inputs_count - low_inputs;
+
+    Word masks[W];
+    for (size_t w = 0; w != W; ++w) {
+        size_t lanes = size_t(1) << low_inputs;
+        size_t first_lane = w * word_bits;
+        masks[w] = lanes >= first_lane + word_bits ? ~Word(0)
+                   : lanes > first_lane ? (Word(1) << (lanes - first_lane)) - 1 : 0;
+    }
+
+    uint64_t count = 0;
+    BlockCounter counter{shared.stats, uint64_t(1) << low_inputs, prog.operators.size() - inputs_count};
+    for (uint64_t block = first_block; block != last_block; ++block) {
+        if (shared.stop != nullptr && shared.stop->load(std::memory_order_relaxed)) {
+            shared.stopped = true;
+            return;
+        }
+        fill_high_inputs<W>(low_inputs, high_inputs, block, values);
+        evaluate<W>(prog, inputs_count, values.data());
+        counter.add();
+
+        Word const* output = values.data() + prog.output_slot * W;
+        for (size_t w = 0; w != W; ++w) {
+            count += static_cast<uint64_t>(__builtin_popcountll(output[w] & masks[w]));
+        }
+    }
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.total.add(BigCount(count));
+}
+
+using CountKernel = void(*)(SimProgram const&, uint64_t, uint64_t, std::vector<Word>&, CountShared&);
+
+void count_scalar(SimProgram const& prog, uint64_t first_block, uint64_t last_block,
+                  std::vector<Word>& values, CountShared& shared) {
+    count_blocks<1>(prog, first_block, last_block, values, shared);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void count_avx2(SimProgram const& prog, uint64_t first_block, uint64_t last_block,
+                std::vector<Word>& values, CountShared& shared) {
+    count_blocks<4>(prog, first_block, last_block, values, shared);
+}
+
+__attribute__((target("avx512f")))
+void count_avx512(SimProgram const& prog, uint64_t first_block, uint64_t last_block,
+                  std::vector<Word>& values, CountShared& shared) {
+    count_blocks<8>(prog, first_block, last_block, values, shared);
+}
+#endif
+
+CountKernel select_count_kernel(SimdLevelEnum level) {
+    switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+        case SimdLevelEnum::AVX512:
+            return &count_avx512;
+        case SimdLevelEnum::AVX2:
+            return &count_avx2;
+#endif
+        default:
+            return &count_scalar;
+    }
+}
+
+template <typename Shared>
+void run_blocks(void (*kernel)(SimProgram const&, uint64_t, uint64_t, std::vector<Word>&, Shared&),
+                SimProgram const& prog, size_t lane_bits, size_t threads_count, Shared& shared) {
+    /**
+     * all blocks of the program on the calling thread or, with several threads, split into prefix cubes
+     * (the highest inputs are fixed) that run on a work-stealing pool, every worker simulates into its own buffer
+     **/
+    size_t inputs_count = prog.input_positions.size();
+    size_t high_inputs = inputs_count > lane_bits ? inputs_count - lane_bits : 0;
+    uint64_t blocks = high_inputs >= word_bits ? UINT64_MAX : (uint64_t(1) << high_inputs);
+
+    if (threads_count == 0) {
+        threads_count = ThreadPool::hardware_threads();
+    }
+
+    if (threads_count == 1 || high_inputs == 0) {
+        std::vector<Word> values;
+        kernel(prog, 0, blocks, values, shared);
+        return;
+    }
+    // about 16 cubes per thread, so stealing evens out cubes that stop early
+    size_t cube_bits = 0;
+    while (cube_bits < high_inputs && cube_bits < 30 && (uint64_t(1) << cube_bits) < 16 * threads_count) {
+        ++cube_bits;
+    }
+    uint64_t cubes = uint64_t(1) << cube_bits;
+    uint64_t cube_size = high_inputs >= word_bits ? (UINT64_MAX >> cube_bits) : (blocks >> cube_bits);
+
+    ThreadPool pool(threads_count);
+    std::vector<std::vector<Word>> buffers(pool.get_threads_count());
+    for (uint64_t cube = 0; cube != cubes; ++cube) {
+        pool.submit([&, cube] {
+            kernel(prog, cube * cube_size, (cube + 1) * cube_size, buffers[ThreadPool::current_worker()], shared);
+        });
+    }
+    pool.wait();
+}
+
+} // namespace
+
+SimdLevelEnum detect_simd_level() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevelEnum::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevelEnum::AVX2;
+    }
+#endif
+    return SimdLevelEnum::SCALAR;
+}
+
+Simulation::Simulation(CircuitSAT const& obj) : Simulation(obj, {obj.get_output_index()}, OperatorsEnum::BUFF) {}
+
+Simulation::Simulation(CircuitSAT const& obj, VecGates const& roots, OperatorsEnum op)
+  : _simd_level(detect_simd_level())
+  , _inputs_count(obj.get_input_gate_indexes().size()) {
+    /**
+     * slots follow the level order cached by CircuitSAT::levelize, so one pass evaluates every gate after its
+     * operands. Only the cones of the roots get slots, a single BUFF root is the output itself, otherwise
+     * one more slot applies op to the roots
+     **/
+    assert(!obj.get_level_order().empty() && "Circuit isn't levelized");
+    assert(!roots.empty() && "Simulation has no roots");
+    size_t const unvisited = SIZE_MAX;
+    size_t const in_cone = SIZE_MAX - 1;
+    std::vector<size_t> slot_of_gate(obj.get_gates_count(), unvisited);
+
+    std::vector<GateIdx> stack(roots.begin(), roots.end());
+    while (!stack.empty()) {
+        GateIdx gate = stack.back();
+        stack.pop_back();
+        if (slot_of_gate[gate] == in_cone) {
+            continue;
+        }
+        assert(obj.get_gate_level(gate) != UINT32_MAX && "Root is outside the levelized cone");
+        slot_of_gate[gate] = in_cone;
+        for (GateIdx operand : obj.get_gate(gate).get_operand_indexes()) {
+            stack.push_back(operand);
+        }
+    }
+
+    // input gates of the cone take the first slots
+    std::vector<GateIdx> order;
+    for (size_t pos = 0; pos != obj.get_input_gate_indexes().size(); ++pos) {
+        GateIdx input = obj.get_input_gate_index(pos);
+        if (slot_of_gate[input] == in_cone) {
+            slot_of_gate[input] = order.size();
+            _program.input_positions.push_back(pos);
+            order.push_back(input);
+        }
+    }
+    for (GateIdx gate : obj.get_level_order()) {
+        if (slot_of_gate[gate] == in_cone) {
+            slot_of_gate[gate] = order.size();
+            order.push_back(gate);
+        }
+    }
+
+    _program.operators.reserve(order.size() + 1);
+    _program.operand_offsets.reserve(order.size() + 2);
+    _program.operand_offsets.push_back(0);
+    for (GateIdx gate : order) {
+        _program.operators.push_back(obj.get_gate(gate).get_operator_type());
+        for (GateIdx operand : obj.get_gate(gate).get_operand_indexes()) {
+            _program.operand_slots.push_back(slot_of_gate[operand]);
+        }
+        _program.operand_offsets.push_back(_program.operand_slots.size());
+    }
+    if (roots.size() == 1 && op == OperatorsEnum::BUFF) {
+        _program.output_slot = slot_of_gate[roots[0]];
+    } else {
+        _program.operators.push_back(op);
+        for (GateIdx root : roots) {
+            _program.operand_slots.push_back(slot_of_gate[root]);
+        }
+        _program.operand_offsets.push_back(_program.operand_slots.size());
+        _program.output_slot = order.size();
+    }
+}
+
+ValueEnum Simulation::search(std::vector<ValueEnum>& assignment, size_t threads_count,
+                             std::atomic<bool> const* stop, Stats* stats) const {
+    /** returns values of all input gates (in the order of CircuitSAT::_input_gate_indexes) that satisfy the output **/
+    SearchShared shared;
+    shared.stop = stop;
+    shared.stats = stats;
+    run_blocks(select_kernel(_simd_level), _program, lane_bits_of(_simd_level), threads_count, shared);
+
+    if (shared.found) {
+        assignment.assign(_inputs_count, ValueEnum::False);
+        for (size_t slot = 0; slot != shared.lanes_assignment.size(); ++slot) {
+            assignment[_program.input_positions[slot]] = shared.lanes_assignment[slot] ? ValueEnum::True
+                                                                                        : ValueEnum::False;
+        }
+        return ValueEnum::True;
+    }
+    return stop != nullptr && stop->load() ? ValueEnum::NotDetermined : ValueEnum::False;
+}
+
+bool Simulation::count(BigCount& result, size_t threads_count, std::atomic<bool> const* stop,
+                       Stats* stats) const {
+    /** number of assignments of the inputs in the cone that set the output, false if stop was set first **/
+    if (_program.input_positions.size() >= word_bits + lane_bits_of(_simd_level)) {
+        return false; // 2^64 blocks are never enumerated, the count stays unknown
+    }
+    CountShared shared;
+    shared.stop = stop;
+    shared.stats = stats;
+    run_blocks(select_count_kernel(_simd_level), _program, lane_bits_of(_simd_level), threads_count, shared);
+
+    result = shared.total;
+    return !shared.stopped;
+}
+
+Word Simulation::simulate(std::vector<Word> const& input_words) const {
+    std::vector<Word> values(_program.operators.size(), 0);
+    size_t inputs_count = _program.input_positions.size();
+    for (size_t slot = 0; slot != inputs_count; ++slot) {
+        values[slot] = input_words.at(_program.input_positions[slot]);
+    }
+    evaluate<1>(_program, inputs_count, values.data());
+    return values[_program.output_slot];
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "BigCount.h"
+#include "Circuit.h"
+#include "Stats.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using Word = uint64_t;
+constexpr size_t word_bits = 64;
+
+enum class SimdLevelEnum { /** widest word the simulation kernels are compiled for */
+    SCALAR,     // 1 x 64 bits
+    AVX2,       // 4 x 64 bits
+    AVX512      // 8 x 64 bits
+};
+
+struct SimProgram {
+    /**
+     * Flat topologically sorted copy of the output cone, slots are dense indexes into the value buffer
+     * @fields:
+     *      operators           -- operator of every slot. Input gates occupy the first slots
+     *      operand_offsets     -- operands of slot s are operand_slots[operand_offsets[s] .. operand_offsets[s + 1])
+     *      operand_slots       -- flattened operands of all slots
+     *      input_positions     -- position in CircuitSAT::_input_gate_indexes of every input slot
+     *      output_slot         -- slot of the output gate (or of op over the roots)
+     **/
+    std::vector<OperatorsEnum> operators;
+    std::vector<size_t> operand_offsets;
+    std::vector<size_t> operand_slots;
+    std::vector<size_t> input_positions;
+    size_t output_slot = 0;
+};
+
+class Simulation {
+    /**
+     * Bit-parallel simulation of the circuit: every gate holds one or several 64-bit words, so one
+     * topological pass evaluates 64/256/512 assignments of the input gates at once.
+     * The word width is chosen at runtime from the SIMD extensions supported by the CPU.
+     * The simulated function is the output of the circuit or op applied to several roots of its levelized cone.
+     *
+     * @methods:
+     *     search               -- enumerate all assignments of the inputs in the output cone on threads_count
+     *                             threads (0 -- all cores) and stop on the first one that sets the output to True,
+     *                             NotDetermined if stop was set before the enumeration finished
+     *     count                -- number of assignments of the inputs in the cone that set the output (popcount of
+     *                             the output words), split over threads as search, false if stop was set first
+     *                             or the cone has too many inputs to enumerate
+     *     simulate             -- one scalar pass over 64 assignments: a word per input gate (in the order of
+     *                             CircuitSAT::_input_gate_indexes), returns the word of the output
+     *     simd_level           -- the kernel selected for this CPU
+     *     search and count add the simulated assignments and gate slots to stats if it isn't nullptr
+     **/
+
+    public:
+        explicit Simulation(CircuitSAT const& obj);
+        Simulation(CircuitSAT const& obj, VecGates const& roots, OperatorsEnum op);
+
+        [[nodiscard]] ValueEnum search(std::vector<ValueEnum>& assignment, size_t threads_count = 1,
+                                       std::atomic<bool> const* stop = nullptr, Stats* stats = nullptr) const;
+        [[nodiscard]] bool count(BigCount& result, size_t threads_count = 1,
+                                 std::atomic<bool> const* stop = nullptr, Stats* stats = nullptr) const;
+        [[nodiscard]] Word simulate(std::vector<Word> const& input_words) const;
+        [[nodiscard]] SimdLevelEnum simd_level() const {return _simd_level;}
+        [[nodiscard]] SimProgram const& get_program() const {return _program;}
+
+    private:
+        SimProgram _program;
+        SimdLevelEnum _simd_level;
+        size_t _inputs_count;
+};
+
+SimdLevelEnum detect_simd_level();
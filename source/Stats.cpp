@@ -0,0 +1,169 @@
+#include "Stats.h"
+#include <cstdio>
+#include <sys/resource.h>
+
+namespace {
+
+std::atomic<bool> allocations_counted{false}; // set by the allocation hook of AllocationCounter.cpp
+// allocations of the calling thread: the phases of one circuit run on one thread, concurrent circuits don't mix
+thread_local uint64_t allocations_count = 0;
+thread_local uint64_t allocated_bytes_count = 0;
+thread_local PhaseTimer* current_timer = nullptr; // innermost timer of the thread, paused by a nested one
+
+constexpr std::string_view phase_names[] = { /** names of PhaseEnum in the order of declaration **/
+        "parse", "cache", "backpropagation", "remove_unused", "rename", "rewrite", "sweeping", "levelize", "solve", "count",
+        "idle"
+};
+
+std::string format_seconds(double seconds) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6f", seconds);
+    return text;
+}
+
+std::string json_phases(uint64_t const (&counts)[phases_count]) {
+    /** JSON object with a counter of every phase **/
+    std::string res;
+    for (size_t pos = 0; pos != phases_count; ++pos) {
+        res += (pos == 0 ? "" : ", ") + ("\"" + std::string(phase_names[pos]) + "\": ") + std::to_string(counts[pos]);
+    }
+    return "{" + res + "}";
+}
+
+} // namespace
+
+std::string json_string(std::string const& str) {
+    /** JSON string literal with the quotes and control characters escaped **/
+    std::string res = "\"";
+    for (char ch : str) {
+        if (ch == '"' || ch == '\\') {
+            res += '\\';
+            res += ch;
+        } else if (static_cast<unsigned char>(ch) < 0x20) {
+            char code[7];
+            std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(ch));
+            res += code;
+        } else {
+            res += ch;
+        }
+    }
+    return res + "\"";
+}
+
+std::string_view Stats::phase_name(PhaseEnum timed) {
+    return phase_names[static_cast<size_t>(timed)];
+}
+
+void Stats::enable_allocation_counting() {
+    allocations_counted.store(true, std::memory_order_relaxed);
+}
+
+bool Stats::counts_allocations() {
+    return allocations_counted.load(std::memory_order_relaxed);
+}
+
+void Stats::count_allocation(size_t bytes) {
+    ++allocations_count;
+    allocated_bytes_count += bytes;
+}
+
+uint64_t Stats::thread_allocations() {
+    return allocations_count;
+}
+
+uint64_t Stats::thread_allocated_bytes() {
+    return allocated_bytes_count;
+}
+
+size_t Stats::peak_rss() {
+    /** ru_maxrss is in kilobytes on Linux **/
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+}
+
+std::string Stats::to_json() const {
+    std::string times;
+    for (size_t pos = 0; pos != phases_count; ++pos) {
+        times += (pos == 0 ? "" : ", ") + ("\"" + std::string(phase_names[pos]) + "\": ") + format_seconds(seconds[pos]);
+    }
+    std::string allocation_fields;
+    if (counts_allocations()) {
+        allocation_fields = ", \"allocations\": " + json_phases(allocations) +
+                            ", \"allocated_bytes\": " + json_phases(allocated_bytes);
+    }
+    return "{\"times\": {" + times + "}" + allocation_fields +
+           ", \"assignments\": " + std::to_string(assignments.load(std::memory_order_relaxed)) +
+           ", \"gate_evaluations\": " + std::to_string(gate_evaluations.load(std::memory_order_relaxed)) +
+           ", \"decisions\": " + std::to_string(decisions.load(std::memory_order_relaxed)) +
+           ", \"conflicts\": " + std::to_string(conflicts.load(std::memory_order_relaxed)) +
+           ", \"propagations\": " + std::to_string(propagations.load(std::memory_order_relaxed)) +
+           ", \"peak_rss\": " + std::to_string(peak_rss()) + "}";
+}
+
+std::string Stats::progress_line() const {
+    return "phase=" + std::string(phase_name(phase.load(std::memory_order_relaxed))) +
+           " assignments=" + std::to_string(assignments.load(std::memory_order_relaxed)) +
+           " gate_evaluations=" + std::to_string(gate_evaluations.load(std::memory_order_relaxed)) +
+           " decisions=" + std::to_string(decisions.load(std::memory_order_relaxed)) +
+           " conflicts=" + std::to_string(conflicts.load(std::memory_order_relaxed)) +
+           " peak_rss=" + std::to_string(peak_rss() >> 20) + "MB";
+}
+
+PhaseTimer::PhaseTimer(Stats* stats, PhaseEnum phase) : _stats(stats), _phase(phase) {
+    if (_stats != nullptr) {
+        _outer_timer = current_timer;
+        if (_outer_timer != nullptr) {
+            _outer_timer->_add_segment();
+        }
+        current_timer = this;
+        _outer_phase = _stats->phase.exchange(phase, std::memory_order_relaxed);
+        _start_segment();
+    }
+}
+
+PhaseTimer::~PhaseTimer() {
+    if (_stats != nullptr) {
+        _add_segment();
+        _stats->phase.store(_outer_phase, std::memory_order_relaxed);
+        current_timer = _outer_timer;
+        if (_outer_timer != nullptr) {
+            _outer_timer->_start_segment();
+        }
+    }
+}
+
+void PhaseTimer::_start_segment() {
+    _start = std::chrono::steady_clock::now();
+    _start_allocations = Stats::thread_allocations();
+    _start_allocated_bytes = Stats::thread_allocated_bytes();
+}
+
+void PhaseTimer::_add_segment() {
+    _stats->add_time(_phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count());
+    _stats->add_allocations(_phase, Stats::thread_allocations() - _start_allocations,
+                            Stats::thread_allocated_bytes() - _start_allocated_bytes);
+}
+
+ProgressReporter::ProgressReporter(Stats const& stats, std::ostream& out, std::chrono::seconds period)
+  : _stats(stats), _out(out), _period(period), _start(std::chrono::steady_clock::now()),
+    _thread(&ProgressReporter::_report, this) {}
+
+ProgressReporter::~ProgressReporter() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finished = true;
+    }
+    _wake.notify_all();
+    _thread.join();
+}
+
+void ProgressReporter::_report() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_wake.wait_for(lock, _period, [this] {return _finished;})) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+        _out << "progress: " + format_seconds(elapsed) + "s " + _stats.progress_line() + "\n" << std::flush;
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+enum class PhaseEnum : uint8_t { /** timed phases of CircuitSAT, the simplify passes are timed one by one */
+    PARSE,
+    CACHE,              // hashing of the BENCH file, loading or saving of the simplified circuit in the cache
+    BACKPROPAGATION,    // simplify: marking the cones of the outputs
+    REMOVE_UNUSED,      // simplify: removal of the gates outside the cones
+    RENAME,             // simplify: dense renaming of the remaining gates
+    REWRITE,            // simplify: AIG conversion, rewriting and rebuilding of the gates, without SWEEPING
+    SWEEPING,           // simplify: SAT sweeping of the AIG
+    LEVELIZE,           // simplify: level order of the output cone
+    SOLVE,
+    COUNT,
+    IDLE                // between the phases, not timed
+};
+
+constexpr size_t phases_count = static_cast<size_t>(PhaseEnum::IDLE);
+
+struct Stats {
+    /**
+     * Counters and timers of one circuit. The engines add to the counters in batches (every few thousand
+     * assignments of the enumeration, every 1024 blocks of the simulation, every restart of the clause-learning
+     * solvers), so the counters are relaxed atomics that a progress reporter may read while the search runs.
+     * Parts of a decomposed output and the threads of an engine add to the stats of the circuit they belong to.
+     * @fields:
+     *      assignments         -- input assignments evaluated by the enumeration and the simulation
+     *      gate_evaluations    -- gate kernel calls: one per gate and assignment for the enumeration,
+     *                             one per gate and block of 64/256/512 assignments for the simulation
+     *      decisions, conflicts, propagations -- of the clause-learning engines (cdcl, circuit, cube, each outputs)
+     *      seconds             -- wall-clock time of every phase, written by the thread running the phase.
+     *                             A phase nested in another one (sweeping in rewrite) is not counted in the outer one
+     *      allocations, allocated_bytes -- heap allocations of every phase made by the thread running it, so the
+     *                             concurrent instances of the batch mode don't mix; the worker threads of an engine
+     *                             or of the parts of a decomposed output are not included. Counted only in the
+     *                             programs linked with the allocation hook (CIRCUITSAT_COUNT_ALLOCATIONS)
+     *      phase               -- phase running now
+     *
+     * @methods:
+     *      add_time            -- add the time of a phase
+     *      add_allocations     -- add the allocations of a phase
+     *      add_evaluations     -- add assignments and gate evaluations of a batch
+     *      to_json             -- JSON object with the times, the counters and the peak resident set
+     *      progress_line       -- one-line summary of the running phase and the counters
+     *      peak_rss            -- peak resident set of the process in bytes, 0 if unknown
+     *      thread_allocations, thread_allocated_bytes -- calls of operator new by the calling thread and their bytes
+     *      count_allocation    -- called by the replacement operator new of AllocationCounter.cpp on every call
+     *      enable_allocation_counting, counts_allocations -- set by the hook when it is linked in, to_json reports
+     *                             the allocations only then
+     **/
+    std::atomic<uint64_t> assignments{0};
+    std::atomic<uint64_t> gate_evaluations{0};
+    std::atomic<uint64_t> decisions{0};
+    std::atomic<uint64_t> conflicts{0};
+    std::atomic<uint64_t> propagations{0};
+    double seconds[phases_count] = {};
+    uint64_t allocations[phases_count] = {};
+    uint64_t allocated_bytes[phases_count] = {};
+    std::atomic<PhaseEnum> phase{PhaseEnum::IDLE};
+
+    void add_time(PhaseEnum timed, double time) {seconds[static_cast<size_t>(timed)] += time;}
+    void add_allocations(PhaseEnum timed, uint64_t count, uint64_t bytes) {
+        allocations[static_cast<size_t>(timed)] += count;
+        allocated_bytes[static_cast<size_t>(timed)] += bytes;
+    }
+    void add_evaluations(uint64_t assigned, uint64_t evaluated) {
+        assignments.fetch_add(assigned, std::memory_order_relaxed);
+        gate_evaluations.fetch_add(evaluated, std::memory_order_relaxed);
+    }
+    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string progress_line() const;
+    static size_t peak_rss();
+    static void enable_allocation_counting();
+    static bool counts_allocations();
+    static void count_allocation(size_t bytes);
+    static uint64_t thread_allocations();
+    static uint64_t thread_allocated_bytes();
+    static std::string_view phase_name(PhaseEnum timed);
+};
+
+std::string json_string(std::string const& str); // shared by the JSON reports of the stats and the batch mode
+
+class PhaseTimer {
+    /**
+     * Scope of a phase: the time and the allocations from construction to destruction are added to the phase,
+     * the phase is the running one in between. A timer started inside another one on the same thread pauses it,
+     * so the phases never overlap. Nothing is measured if stats is nullptr
+     **/
+
+    public:
+        PhaseTimer(Stats* stats, PhaseEnum phase);
+        ~PhaseTimer();
+
+        PhaseTimer(PhaseTimer const&) = delete;
+        PhaseTimer& operator=(PhaseTimer const&) = delete;
+
+    private:
+        void _start_segment();
+        void _add_segment();
+
+        Stats* _stats;
+        PhaseEnum _phase;
+        PhaseEnum _outer_phase = PhaseEnum::IDLE;
+        PhaseTimer* _outer_timer = nullptr;
+        std::chrono::steady_clock::time_point _start;
+        uint64_t _start_allocations = 0;
+        uint64_t _start_allocated_bytes = 0;
+};
+
+class ProgressReporter {
+    /**
+     * Thread that writes the progress line of the stats to out every period until it is destroyed
+     * @private_fields:
+     *      _stats, _out, _period -- what is reported, where and how often
+     *      _start              -- time of construction, progress lines show the time elapsed since it
+     *      _mutex, _wake, _finished -- stop the thread without waiting for the rest of the period
+     **/
+
+    public:
+        ProgressReporter(Stats const& stats, std::ostream& out, std::chrono::seconds period);
+        ~ProgressReporter();
+
+        ProgressReporter(ProgressReporter const&) = delete;
+        ProgressReporter& operator=(ProgressReporter const&) = delete;
+
+    private:
+        void _report();
+
+        Stats const& _stats;
+        std::ostream& _out;
+        std::chrono::seconds _period;
+        std::chrono::steady_clock::time_point _start;
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        bool _finished = false;
+        std::thread _thread;
+};
@@ -0,0 +1,105 @@
+#include "ThreadPool.h"
+
+namespace {
+
+thread_local size_t worker_index = 0;
+thread_local ThreadPool const* worker_pool = nullptr;
+
+} // namespace
+
+size_t ThreadPool::hardware_threads() {
+    size_t threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+size_t ThreadPool::current_worker() {
+    return worker_index;
+}
+
+ThreadPool::ThreadPool(size_t threads_count) {
+    if (threads_count == 0) {
+        threads_count = hardware_threads();
+    }
+    for (size_t index = 0; index != threads_count; ++index) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t index = 0; index != threads_count; ++index) {
+        _workers.emplace_back(&ThreadPool::_worker_loop, this, index);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t queue;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        queue = worker_pool == this ? worker_index : _next_queue++ % _queues.size();
+        ++_pending;
+        ++_queued; // counted before the push, so a woken worker at worst retries until the task appears
+    }
+    {
+        std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+        _queues[queue]->tasks.push_back(std::move(task));
+    }
+    _wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this] {return _pending == 0;});
+}
+
+bool ThreadPool::_pop_task(size_t index, std::function<void()>& task) {
+    /** own deque from the back, then steal from the front of the others **/
+    for (size_t shift = 0; shift != _queues.size(); ++shift) {
+        Queue& queue = *_queues[(index + shift) % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (shift == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        --_queued;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::_worker_loop(size_t index) {
+    worker_index = index;
+    worker_pool = this;
+    std::function<void()> task;
+
+    while (true) {
+        if (_pop_task(index, task)) {
+            task();
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_pending == 0) {
+                _done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.wait(lock, [this] {return _stop || _queued > 0;});
+        if (_stop && _queued == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+    /**
+     * Fixed set of worker threads with work stealing: every worker owns a deque, takes its tasks from the back
+     * and steals from the front of the other deques when its own one is empty.
+     * Tasks submitted by a worker go to its own deque, tasks submitted from outside are spread round-robin.
+     * @methods:
+     *      submit              -- add a task
+     *      wait                -- block until every submitted task has finished
+     *      current_worker      -- index of the worker running the calling code (0 outside the pool)
+     **/
+
+    public:
+        explicit ThreadPool(size_t threads_count = 0);
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const&) = delete;
+        ThreadPool& operator=(ThreadPool const&) = delete;
+
+        void submit(std::function<void()> task);
+        void wait();
+
+        [[nodiscard]] size_t get_threads_count() const {return _workers.size();}
+        static size_t current_worker();
+        static size_t hardware_threads();
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void _worker_loop(size_t index);
+        bool _pop_task(size_t index, std::function<void()>& task);
+
+        std::vector<std::unique_ptr<Queue>> _queues;
+        std::vector<std::thread> _workers;
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::condition_variable _done;
+        std::atomic<size_t> _queued{0};
+        size_t _pending = 0;
+        size_t _next_queue = 0;
+        bool _stop = false;
+};
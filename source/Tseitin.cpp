@@ -0,0 +1,148 @@
+#include "Tseitin.h"
+#include <cassert>
+
+Lit TseitinEncoding::encode(CircuitSAT const& obj, GateIdx gate) {
+    /** explicit-stack DFS: operands are encoded before the gates that use them **/
+    if (_gate_vars.size() < obj.get_gates_count()) {
+        _gate_vars.resize(obj.get_gates_count(), -1);
+    }
+
+    std::vector<std::pair<GateIdx, size_t>> stack; // [gate, next operand to visit]
+    if (!is_encoded(gate)) {
+        _gate_vars[gate] = _solver.new_var();
+        stack.emplace_back(gate, 0);
+    }
+
+    while (!stack.empty()) {
+        auto& [top, next] = stack.back();
+        GateRange operands = obj.get_gate(top).get_operand_indexes();
+
+        if (next != operands.size()) {
+            GateIdx operand = operands[next++];
+            if (!is_encoded(operand)) {
+                _gate_vars[operand] = _solver.new_var();
+                stack.emplace_back(operand, 0);
+            }
+            continue;
+        }
+
+        _encode_gate(obj, top);
+        stack.pop_back();
+    }
+    return get_literal(gate);
+}
+
+void TseitinEncoding::_encode_gate(CircuitSAT const& obj, GateIdx gate) {
+    /** clauses linking the gate variable with its operands **/
+    Gate current = obj.get_gate(gate);
+    OperatorsEnum op = current.get_operator_type();
+    assert(op != OperatorsEnum::UNKNOWN && "Gate has no operator");
+
+    Lit out = get_literal(gate);
+    std::vector<Lit> operands;
+    for (GateIdx operand : current.get_operand_indexes()) {
+        operands.push_back(get_literal(operand));
+    }
+
+    switch (op) {
+        case OperatorsEnum::INPUT:
+            break;
+
+        case OperatorsEnum::NOT:
+        case OperatorsEnum::BUFF: {
+            Lit in = op == OperatorsEnum::NOT ? lit_neg(operands[0]) : operands[0];
+            _solver.add_clause({lit_neg(out), in});
+            _solver.add_clause({out, lit_neg(in)});
+            break;
+        }
+
+        case OperatorsEnum::AND:
+        case OperatorsEnum::NAND:
+        case OperatorsEnum::OR:
+        case OperatorsEnum::NOR: {
+            // OR(a, b) = NOT(AND(NOT a, NOT b)): encode both as y = AND over (possibly negated) operands
+            bool negated_inputs = op == OperatorsEnum::OR || op == OperatorsEnum::NOR;
+            bool negated_output = op == OperatorsEnum::NAND || op == OperatorsEnum::OR;
+            Lit y = negated_output ? lit_neg(out) : out;
+
+            std::vector<Lit> long_clause{y};
+            for (Lit operand : operands) {
+                Lit in = negated_inputs ? lit_neg(operand) : operand;
+                _solver.add_clause({lit_neg(y), in});
+                long_clause.push_back(lit_neg(in));
+            }
+            _solver.add_clause(long_clause);
+            break;
+        }
+
+        case OperatorsEnum::XOR:
+        case OperatorsEnum::NXOR: {
+            // chain of binary XORs through auxiliary variables
+            Lit acc = operands[0];
+            for (size_t pos = 1; pos != operands.size(); ++pos) {
+                bool last = pos + 1 == operands.size();
+                Lit res = last ? (op == OperatorsEnum::XOR ? out : lit_neg(out)) : make_lit(_solver.new_var());
+                Lit b = operands[pos];
+                _solver.add_clause({lit_neg(res), acc, b});
+                _solver.add_clause({lit_neg(res), lit_neg(acc), lit_neg(b)});
+                _solver.add_clause({res, lit_neg(acc), b});
+                _solver.add_clause({res, acc, lit_neg(b)});
+                acc = res;
+            }
+            if (operands.size() == 1) {
+                Lit res = op == OperatorsEnum::XOR ? out : lit_neg(out);
+                _solver.add_clause({lit_neg(res), acc});
+                _solver.add_clause({res, lit_neg(acc)});
+            }
+            break;
+        }
+
+        default:
+            assert(false && "Unsupported operator");
+    }
+}
+
+Lit AigEncoding::encode(Aig const& aig, AigLit lit) {
+    /** encoding of the cone of the literal, nodes that are already encoded are skipped **/
+    if (_node_vars.size() < aig.get_nodes_count()) {
+        _node_vars.resize(aig.get_nodes_count(), -1);
+    }
+    std::vector<uint32_t> stack{aig_node(lit)};
+    while (!stack.empty()) {
+        uint32_t node = stack.back();
+        if (is_encoded(node)) {
+            stack.pop_back();
+            continue;
+        }
+        if (!aig.is_and(node)) {
+            _node_vars[node] = _solver.new_var();
+            if (node == 0) { // the constant node is False
+                _solver.add_clause({make_lit(_node_vars[node], true)});
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        uint32_t lhs = aig_node(aig.get_fanin0(node));
+        uint32_t rhs = aig_node(aig.get_fanin1(node));
+        if (!is_encoded(lhs) || !is_encoded(rhs)) {
+            if (!is_encoded(lhs)) {
+                stack.push_back(lhs);
+            }
+            if (!is_encoded(rhs)) {
+                stack.push_back(rhs);
+            }
+            continue;
+        }
+        stack.pop_back();
+
+        Lit y = make_lit(_solver.new_var());
+        Lit a = make_lit(_node_vars[lhs], aig_is_complemented(aig.get_fanin0(node)));
+        Lit b = make_lit(_node_vars[rhs], aig_is_complemented(aig.get_fanin1(node)));
+        _solver.add_clause({lit_neg(y), a});
+        _solver.add_clause({lit_neg(y), b});
+        _solver.add_clause({y, lit_neg(a), lit_neg(b)});
+        _node_vars[node] = lit_var(y);
+    }
+    return make_lit(_node_vars[aig_node(lit)], aig_is_complemented(lit));
+}
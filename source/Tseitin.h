@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Aig.h"
+#include "Circuit.h"
+#include "Cdcl.h"
+#include <vector>
+
+class TseitinEncoding {
+    /**
+     * Tseitin encoding of the gates into CNF of a CdclSolver.
+     * Gates are encoded lazily: encode(gate) adds clauses for the whole not yet encoded cone of the gate,
+     * so the same encoding can be extended by later queries.
+     * @private_fields:
+     *      _solver             -- solver that receives the clauses
+     *      _gate_vars          -- variable of every gate, -1 if the gate isn't encoded yet
+     **/
+
+    public:
+        explicit TseitinEncoding(CdclSolver& solver) : _solver(solver) {};
+
+        Lit encode(CircuitSAT const& obj, GateIdx gate);
+        [[nodiscard]] bool is_encoded(GateIdx gate) const {return gate < _gate_vars.size() && _gate_vars[gate] >= 0;}
+        [[nodiscard]] Lit get_literal(GateIdx gate) const {return make_lit(_gate_vars.at(gate));}
+
+    private:
+        void _encode_gate(CircuitSAT const& obj, GateIdx gate);
+
+        CdclSolver& _solver;
+        std::vector<Var> _gate_vars;
+};
+
+class AigEncoding {
+    /**
+     * Tseitin encoding of the nodes of an AIG, three clauses per AND node. Nodes are encoded lazily
+     * like in TseitinEncoding, the graph may grow between the calls
+     * @private_fields:
+     *      _solver             -- solver that receives the clauses
+     *      _node_vars          -- variable of every node, -1 if the node isn't encoded yet
+     **/
+
+    public:
+        explicit AigEncoding(CdclSolver& solver) : _solver(solver) {};
+
+        Lit encode(Aig const& aig, AigLit lit);
+        [[nodiscard]] bool is_encoded(uint32_t node) const {return node < _node_vars.size() && _node_vars[node] >= 0;}
+        [[nodiscard]] Var get_var(uint32_t node)     const {return _node_vars.at(node);}
+
+    private:
+        CdclSolver& _solver;
+        std::vector<Var> _node_vars;
+};
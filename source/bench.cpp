@@ -0,0 +1,207 @@
+#include "Circuit.h"
+#include "Generator.h"
+#include "Options.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Instance {
+    FamilyEnum family;
+    size_t size;
+};
+
+const std::vector<Instance> default_suite { /** every family at a size that takes up to a second with the default engine **/
+        {FamilyEnum::ADDER,      32},
+        {FamilyEnum::MULTIPLIER, 8},
+        {FamilyEnum::RANDOM,     5000},
+        {FamilyEnum::XOR_CHAIN,  64},
+        {FamilyEnum::BUFF_CHAIN, 200000},
+        {FamilyEnum::DUPLICATES, 200000}
+};
+
+struct PhaseTimes {
+    /** seconds of one phase in every repetition **/
+    std::vector<double> seconds;
+
+    [[nodiscard]] double min() const {return *std::min_element(seconds.begin(), seconds.end());}
+    [[nodiscard]] double median() const {
+        std::vector<double> sorted = seconds;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[sorted.size() / 2];
+    }
+};
+
+template <class Func>
+double measure(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string json_number(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6g", value);
+    return text;
+}
+
+std::string json_phase(PhaseTimes const& times, std::string const& rate_name, double work) {
+    /** times of the phase and its throughput by the best repetition, null if the work isn't defined **/
+    double best = std::max(times.min(), 1e-9);
+    return "{\"min\": " + json_number(times.min()) + ", \"median\": " + json_number(times.median()) +
+           ", \"" + rate_name + "\": " + (std::isnan(work) ? "null" : json_number(work / best)) + "}";
+}
+
+bool parse_instance(std::string const& arg, Instance& instance) {
+    /** <family>:<size> **/
+    size_t colon = arg.find(':');
+    return colon != std::string::npos && CircuitGenerator::find_family(arg.substr(0, colon), instance.family) &&
+           str_to_count(arg.substr(colon + 1), instance.size) && instance.size != 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    /**
+     * CircuitSAT_bench [<family>:<size> ...] [--engine=recursive|simulation|cdcl|circuit|cube] [--threads=N]
+     *                  [--repeat=N] [--seed=N] [--arity=K] [--inputs=N] [--dir=<directory>]
+     * CircuitSAT_bench <family>:<size> --emit=<bench file> [--seed=N] [--arity=K] [--inputs=N]
+     * families: adder, multiplier, random, xor, buff, duplicates; without instances the default suite is run.
+     * Every instance is generated, then parsed, simplified and solved repeat times, one JSON line per instance
+     **/
+    const std::string engine_option = "--engine=";
+    const std::string threads_option = "--threads=";
+    const std::string repeat_option = "--repeat=";
+    const std::string seed_option = "--seed=";
+    const std::string arity_option = "--arity=";
+    const std::string inputs_option = "--inputs=";
+    const std::string dir_option = "--dir=";
+    const std::string emit_option = "--emit=";
+
+    std::vector<Instance> instances;
+    std::string engine_name = "simulation";
+    EngineEnum engine = EngineEnum::SIMULATION;
+    size_t threads_count = 1;
+    size_t repeat = 5;
+    size_t seed = 1;
+    size_t arity = 2;
+    size_t inputs = 20;
+    std::string dir = std::filesystem::temp_directory_path().string();
+    std::string emit_path;
+    for (int pos = 1; pos != argc; ++pos) {
+        std::string arg = argv[pos];
+        Instance instance{};
+        if (arg.rfind(engine_option, 0) == 0) {
+            engine_name = arg.substr(engine_option.size());
+            if (!str_to_enum_engine(engine_name, engine)) {
+                std::cerr << "Unknown engine: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(threads_option, 0) == 0) {
+            if (!str_to_count(arg.substr(threads_option.size()), threads_count)) {
+                std::cerr << "Wrong number of threads: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(repeat_option, 0) == 0) {
+            if (!str_to_count(arg.substr(repeat_option.size()), repeat) || repeat == 0) {
+                std::cerr << "Wrong number of repetitions: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(seed_option, 0) == 0) {
+            if (!str_to_count(arg.substr(seed_option.size()), seed)) {
+                std::cerr << "Wrong seed: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(arity_option, 0) == 0) {
+            if (!str_to_count(arg.substr(arity_option.size()), arity) || arity < 2) {
+                std::cerr << "Wrong arity: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(inputs_option, 0) == 0) {
+            if (!str_to_count(arg.substr(inputs_option.size()), inputs) || inputs < 2) {
+                std::cerr << "Wrong number of inputs: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(dir_option, 0) == 0) {
+            dir = arg.substr(dir_option.size());
+        } else if (arg.rfind(emit_option, 0) == 0) {
+            emit_path = arg.substr(emit_option.size());
+        } else if (parse_instance(arg, instance)) {
+            instances.push_back(instance);
+        } else {
+            std::cerr << "Unknown instance: " + arg << std::endl;
+            return 1;
+        }
+    }
+
+    CircuitGenerator generator(seed, arity, inputs);
+    if (!emit_path.empty()) {
+        if (instances.size() != 1) {
+            std::cerr << "One instance is generated at a time" << std::endl;
+            return 1;
+        }
+        std::ofstream out(emit_path);
+        generator.generate(instances[0].family, instances[0].size, out);
+        return out ? 0 : 1;
+    }
+
+    if (instances.empty()) {
+        instances = default_suite;
+    }
+    for (Instance const& instance : instances) {
+        std::string family = std::string(CircuitGenerator::family_name(instance.family));
+        std::string path = (std::filesystem::path(dir) / ("CircuitSAT_bench_" + std::to_string(getpid()) + "_" +
+                                                          family + ".bench")).string();
+        {
+            std::ofstream out(path);
+            generator.generate(instance.family, instance.size, out);
+            if (!out) {
+                std::cerr << "Can't write the circuit: " + path << std::endl;
+                return 1;
+            }
+        }
+
+        PhaseTimes parse_times;
+        PhaseTimes simplify_times;
+        PhaseTimes solve_times;
+        size_t gates = 0;
+        size_t simplified = 0;
+        size_t simplified_inputs = 0;
+        std::string result;
+        for (size_t rep = 0; rep != repeat; ++rep) {
+            CircuitSAT circuit;
+            circuit.set_engine(engine);
+            circuit.set_threads_count(threads_count);
+            parse_times.seconds.push_back(measure([&] {circuit.parse(path);}));
+            gates = circuit.get_gates_count();
+            simplify_times.seconds.push_back(measure([&] {circuit.simplify();}));
+            simplified = circuit.get_gates_count();
+            simplified_inputs = circuit.get_input_gate_indexes().size();
+            solve_times.seconds.push_back(measure([&] {circuit.solve();}));
+            result = circuit.show_result();
+        }
+        std::filesystem::remove(path);
+
+        // the whole space of the simplified inputs is covered only if no assignment satisfies the circuit
+        double assignments = result == "UNSAT" ? std::ldexp(1.0, static_cast<int>(simplified_inputs)) : NAN;
+        std::cout << "{\"family\": \"" + family + "\", \"size\": " + std::to_string(instance.size) +
+                     ", \"engine\": \"" + engine_name + "\", \"threads\": " + std::to_string(threads_count) +
+                     ", \"repeat\": " + std::to_string(repeat) + ", \"gates\": " + std::to_string(gates) +
+                     ", \"simplified\": " + std::to_string(simplified) +
+                     ", \"inputs\": " + std::to_string(simplified_inputs) + ", \"result\": \"" + result + "\"" +
+                     ", \"parse\": " + json_phase(parse_times, "gates_per_sec", static_cast<double>(gates)) +
+                     ", \"simplify\": " + json_phase(simplify_times, "gates_per_sec", static_cast<double>(gates)) +
+                     ", \"solve\": " + json_phase(solve_times, "assignments_per_sec", assignments) + "}"
+                  << std::endl;
+    }
+    return 0;
+}
@@ -1,28 +1,284 @@
 #include "Circuit.h"
+#include "Batch.h"
+#include "Incremental.h"
+#include "Options.h"
+#include <chrono>
+#include <memory>
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 int main(int argc, char *argv[])
 {
-    if (argc == 3) {
+    /**
+     * CircuitSAT <bench file> <result file> [--engine=recursive|simulation|cdcl|circuit|cube] [--threads=N]
+     *            [--outputs=any|each|all] [--assume=<gate>=0|1 ...] [--model=<file>] [--model-format=text|binary]
+     *            [--check] [--count] [--stats=<file>] [--progress=seconds] [--cache=<directory>] [--no-sweeping]
+     * CircuitSAT --batch=<directory|manifest> <result file|-> [--engine=...] [--threads=N] [--outputs=...]
+     *            [--jobs=N] [--timeout=seconds] [--process-memory=megabytes] [--model] [--check] [--count] [--stats]
+     *            [--cache=<directory>] [--no-sweeping]
+     **/
+    const std::string engine_option = "--engine=";
+    const std::string threads_option = "--threads=";
+    const std::string batch_option = "--batch=";
+    const std::string jobs_option = "--jobs=";
+    const std::string timeout_option = "--timeout=";
+    const std::string memory_option = "--process-memory=";
+    const std::string assume_option = "--assume=";
+    const std::string model_option = "--model=";
+    const std::string model_format_option = "--model-format=";
+    const std::string outputs_option = "--outputs=";
+    const std::string stats_option = "--stats=";
+    const std::string progress_option = "--progress=";
+    const std::string cache_option = "--cache=";
 
-        std::ofstream out1(argv[2], std::ios::app);
-        out1 << argv[1];
+    std::vector<std::string> paths;
+    EngineEnum engine = EngineEnum::RECURSIVE;
+    bool engine_chosen = false;
+    size_t threads_count = 1;
+    std::string batch_source;
+    size_t jobs_count = 1;
+    size_t timeout = 0;
+    size_t memory = 0;
+    std::vector<std::pair<std::string, bool>> assumptions;
+    std::string model_path;
+    bool model_inline = false;
+    bool model_binary = false;
+    bool check = false;
+    bool count = false;
+    bool sweeping = true;
+    std::string stats_path;
+    bool stats_inline = false;
+    size_t progress_period = 0;
+    std::string cache_dir;
+    OutputsEnum outputs_mode = OutputsEnum::ANY;
+    for (int pos = 1; pos != argc; ++pos) {
+        std::string arg = argv[pos];
+        if (arg.rfind(engine_option, 0) == 0) {
+            if (!str_to_enum_engine(arg.substr(engine_option.size()), engine)) {
+                std::cerr << "Unknown engine: " + arg << std::endl;
+                return 1;
+            }
+            engine_chosen = true;
+        } else if (arg.rfind(threads_option, 0) == 0) {
+            if (!str_to_count(arg.substr(threads_option.size()), threads_count)) {
+                std::cerr << "Wrong number of threads: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(jobs_option, 0) == 0) {
+            if (!str_to_count(arg.substr(jobs_option.size()), jobs_count)) {
+                std::cerr << "Wrong number of jobs: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(timeout_option, 0) == 0) {
+            if (!str_to_count(arg.substr(timeout_option.size()), timeout)) {
+                std::cerr << "Wrong time limit: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(memory_option, 0) == 0) {
+            if (!str_to_count(arg.substr(memory_option.size()), memory)) {
+                std::cerr << "Wrong memory limit: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(assume_option, 0) == 0) {
+            std::string value = arg.substr(assume_option.size());
+            size_t eq = value.rfind('=');
+            if (eq == std::string::npos || eq == 0 || (value.substr(eq + 1) != "0" && value.substr(eq + 1) != "1")) {
+                std::cerr << "Wrong assumption: " + arg << std::endl;
+                return 1;
+            }
+            assumptions.emplace_back(value.substr(0, eq), value.substr(eq + 1) == "1");
+        } else if (arg.rfind(model_option, 0) == 0) {
+            model_path = arg.substr(model_option.size());
+        } else if (arg == "--model") {
+            model_inline = true;
+        } else if (arg.rfind(model_format_option, 0) == 0) {
+            std::string format = arg.substr(model_format_option.size());
+            if (format != "text" && format != "binary") {
+                std::cerr << "Unknown model format: " + arg << std::endl;
+                return 1;
+            }
+            model_binary = format == "binary";
+        } else if (arg.rfind(outputs_option, 0) == 0) {
+            if (!str_to_enum_outputs(arg.substr(outputs_option.size()), outputs_mode)) {
+                std::cerr << "Unknown outputs mode: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg == "--check") {
+            check = true;
+        } else if (arg == "--count") {
+            count = true;
+        } else if (arg == "--no-sweeping") {
+            sweeping = false;
+        } else if (arg.rfind(stats_option, 0) == 0) {
+            stats_path = arg.substr(stats_option.size());
+        } else if (arg == "--stats") {
+            stats_inline = true;
+        } else if (arg.rfind(progress_option, 0) == 0) {
+            if (!str_to_count(arg.substr(progress_option.size()), progress_period)) {
+                std::cerr << "Wrong progress period: " + arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind(cache_option, 0) == 0) {
+            cache_dir = arg.substr(cache_option.size());
+        } else if (arg.rfind(batch_option, 0) == 0) {
+            batch_source = arg.substr(batch_option.size());
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (!batch_source.empty() && paths.size() == 1) {
+        std::vector<std::string> bench_paths;
+        if (!BatchSolver::collect_paths(batch_source, bench_paths)) {
+            std::cerr << "Can't read directory or manifest: " + batch_source << std::endl;
+            return 1;
+        }
+        BatchSolver batch(engine, threads_count, jobs_count);
+        batch.set_time_limit(timeout);
+        batch.set_process_memory_limit(memory);
+        batch.set_model_output(model_inline);
+        batch.set_check(check);
+        batch.set_outputs_mode(outputs_mode);
+        batch.set_count(count);
+        batch.set_sweeping(sweeping);
+        batch.set_stats_output(stats_inline);
+        batch.set_cache_dir(cache_dir);
+
+        if (paths[0] == "-") {
+            batch.run(bench_paths, std::cout);
+        } else {
+            std::ofstream out(paths[0], std::ios::app);
+            batch.run(bench_paths, out);
+        }
+        return 0;
+    }
+
+    if (count && !assumptions.empty()) {
+        std::cerr << "Models can't be counted under assumptions" << std::endl;
+        return 1;
+    }
+    if (engine_chosen && !assumptions.empty()) {
+        std::cerr << "Assumptions are solved by the incremental CDCL solver, --engine can't be used with them"
+                  << std::endl;
+        return 1;
+    }
+
+    if (batch_source.empty() && paths.size() == 2 && !assumptions.empty()) {
+        // assumptions may name any gate, so the circuit isn't simplified: the incremental solver sweeps it as a whole
         CircuitSAT circuit;
+        circuit.set_outputs_mode(outputs_mode);
+        circuit.set_sweeping(sweeping);
+        try {
+            circuit.parse(paths[0]);
+        } catch (ParseError const& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        IncrementalSolver solver(circuit);
+
+        std::vector<Assumption> gates{{UINT32_MAX, true}}; // the objective, one query per output
+        for (auto const& [name, value] : assumptions) {
+            GateIdx gate = solver.find_gate(name);
+            if (gate == UINT32_MAX) {
+                std::cerr << "Unknown gate: " + name << std::endl;
+                return 1;
+            }
+            gates.emplace_back(gate, value);
+        }
+        std::string count = std::to_string(circuit.get_gates_count());
+        std::string result;
+        bool sat = false;
+        for (GateIdx output : circuit.get_output_indexes()) {
+            gates.front().first = output;
+            sat = solver.solve(gates) == ValueEnum::True;
+            std::string output_result = sat ? "SAT" : "UNSAT";
+            if (outputs_mode == OutputsEnum::EACH) {
+                output_result = std::string(circuit.get_gate(output).get_name()) + "=" + output_result;
+            }
+            result += (result.empty() ? "" : " ") + output_result;
+        }
+
+        std::ofstream out(paths[1], std::ios::app);
+        out << paths[0] + " -- " + count + "; " + count + " => " + result + "\n";
+        out.close();
+
+        sat = sat && outputs_mode != OutputsEnum::EACH; // the outputs have different models
+        if (sat && (!model_path.empty() || check)) { // the model of the query becomes the witness of the circuit
+            for (GateIdx input : circuit.get_input_gate_indexes()) {
+                circuit.set_gate_value(input, solver.model_value(input));
+            }
+        }
+        if (sat && !model_path.empty() && !circuit.write_witness(model_path, model_binary)) {
+            std::cerr << "Can't write the model: " + model_path << std::endl;
+            return 1;
+        }
+        if (sat && check && !CircuitSAT::check_witness(paths[0], circuit.get_witness(), outputs_mode)) {
+            std::cerr << "The model doesn't satisfy the circuit: " + paths[0] << std::endl;
+            return 2;
+        }
+        return 0;
+    }
+
+    if (batch_source.empty() && paths.size() == 2) {
+        Stats stats;
+        std::unique_ptr<ProgressReporter> progress;
+        if (progress_period != 0) {
+            progress = std::make_unique<ProgressReporter>(stats, std::cerr, std::chrono::seconds(progress_period));
+        }
+        auto write_stats = [&stats, &progress, &stats_path, &paths] {
+            progress.reset();
+            if (!stats_path.empty()) {
+                std::ofstream out(stats_path, std::ios::app);
+                out << "{\"path\": " + json_string(paths[0]) + ", \"stats\": " + stats.to_json() + "}\n";
+            }
+        };
+
+        CircuitSAT circuit;
+        circuit.set_engine(engine);
+        circuit.set_threads_count(threads_count);
+        circuit.set_outputs_mode(outputs_mode);
+        circuit.set_sweeping(sweeping);
+        if (progress || !stats_path.empty()) {
+            circuit.set_stats(&stats);
+        }
+
+        try {
+            circuit.load_simplified(paths[0], cache_dir);
+        } catch (ParseError const& error) {
+            progress.reset();
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        std::string line = paths[0] + " -- " + std::to_string(circuit.get_parsed_gates_count()) + "; " +
+                           std::to_string(circuit.get_gates_count()) + " => ";
 
-        circuit.parse(argv[1]);
-        out1 << " -- " + std::to_string(circuit.get_gates().size()) + "; ";
+        if (count) {
+            circuit.count();
+            write_stats();
+            std::ofstream out(paths[1], std::ios::app);
+            out << line + circuit.show_count() + "\n";
+            return 0;
+        }
 
-        circuit.simplify();
-        out1 << std::to_string(circuit.get_gates().size()) + " => ";
-        out1.close();
+        bool result = circuit.solve();
+        line += circuit.show_result() + "\n";
+        write_stats();
 
-        std::ofstream out2(argv[2], std::ios::app);
-        circuit.solve();
-        out2 << circuit.show_result() + "\n";
-        out2.close();
+        std::ofstream out(paths[1], std::ios::app);
+        out << line;
+        out.close();
 
+        result = result && outputs_mode != OutputsEnum::EACH; // the outputs have different models
+        if (result && !model_path.empty() && !circuit.write_witness(model_path, model_binary)) {
+            std::cerr << "Can't write the model: " + model_path << std::endl;
+            return 1;
+        }
+        if (result && check && !CircuitSAT::check_witness(paths[0], circuit.get_witness(), outputs_mode)) {
+            std::cerr << "The model doesn't satisfy the circuit: " + paths[0] << std::endl;
+            return 2;
+        }
         return 0;
     }
 